@@ -28,8 +28,39 @@
  #define tskIDLE_PRIORITY                      0
  #define configMAX_PRIORITIES                  32
  
+ // Kernel configuration
+ #define configTICK_RATE_HZ                    1000
+ #define configUSE_TICK_HOOK                   1
+ #define configUSE_TICKLESS_IDLE               1
+ #define configTIMER_QUEUE_LENGTH              8
+ 
+ #define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000))
+ 
+ // Critical sections (mask the tick interrupt on target, a mutex on the host port)
+ #define taskENTER_CRITICAL()                  vPortEnterCritical()
+ #define taskEXIT_CRITICAL()                   vPortExitCritical()
+ 
+ // Tickless idle entry point
+ #define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) vPortSuppressTicksAndSleep(xExpectedIdleTime)
+ 
  // Function prototypes (minimal subset required for our simulation)
  TickType_t xTaskGetTickCount(void);
  void vTaskDelay(TickType_t xTicksToDelay);
  
+ // Port layer
+ void vPortEnterCritical(void);
+ void vPortExitCritical(void);
+ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+ 
+ // Host port extensions (not part of the FreeRTOS API): cost of the tick
+ // interrupt as measured by the host stand-in kernel
+ typedef struct {
+     uint64_t ticksProcessed;   // Tick interrupts taken
+     uint64_t ticksSuppressed;  // Ticks skipped by tickless idle
+     uint64_t tickTotalNs;      // Time spent in tick processing
+     uint64_t tickMaxNs;        // Longest single tick
+ } PortTickStats;
+ 
+ void vPortGetTickStats(PortTickStats *pxStats);
+ 
  #endif /* FREERTOS_H */
\ No newline at end of file
@@ -0,0 +1,92 @@
+/**
+ * aperiodic_server.c - Bandwidth servers for aperiodic jobs under EDF
+ *
+ * A server is an ordinary entry in the task set whose period (Ts) and WCET
+ * (Qs) define its bandwidth Us = Qs / Ts. Aperiodic jobs queue at the server
+ * in FIFO order and the server presents the head job to the EDF scheduler
+ * with a deadline chosen so that it never uses more than its bandwidth:
+ *
+ *   TBS: d_k = max(r_k, d_k-1) + C_k / Us
+ *   CBS: a budget of Qs is consumed while the server runs; when it is
+ *        exhausted it is recharged and the deadline postponed by Ts.
+ */
+
+ #include <stdio.h>
+ #include "aperiodic_server.h"
+ 
+ unsigned int serverQueuedJobs(const Task *server) {
+     return server->nextArrival - server->nextServedJob;
+ }
+ 
+ // CBS rule for a job arriving at an idle server: keep the current deadline
+ // only if the leftover budget would not exceed the server bandwidth
+ static void cbsReplenishIfNeeded(Task *server, TickType_t releaseTime) {
+     bool expired = server->serverDeadline <= releaseTime;
+     
+     if (expired || (unsigned long long)server->serverBudget * server->period >=
+                    (unsigned long long)(server->serverDeadline - releaseTime) * server->worstCaseExecTime) {
+         server->serverDeadline = releaseTime + server->period;
+         server->serverBudget = server->worstCaseExecTime;
+     }
+ }
+ 
+ void serverJobArrival(Task *server, TickType_t currentTime) {
+     // The job at nextArrival has been released and joins the queue
+     bool wasIdle = (server->state == TASK_IDLE && serverQueuedJobs(server) == 0);
+     server->nextArrival++;
+     
+     if (server->kind == TASK_SERVER_CBS && wasIdle) {
+         cbsReplenishIfNeeded(server, currentTime);
+     }
+     
+     if (server->state == TASK_IDLE) {
+         serverDispatchNextJob(server, currentTime);
+     }
+ }
+ 
+ void serverDispatchNextJob(Task *server, TickType_t currentTime) {
+     (void)currentTime;
+     
+     if (serverQueuedJobs(server) == 0) {
+         return;
+     }
+     
+     const ArrivalRecord *job = &server->arrivals[server->nextServedJob++];
+     
+     if (server->kind == TASK_SERVER_TBS) {
+         // Deadline proportional to the job's demand at the server bandwidth
+         TickType_t start = job->releaseTime > server->serverDeadline ?
+                            job->releaseTime : server->serverDeadline;
+         TickType_t span = (TickType_t)(((unsigned long long)job->executionTime * server->period +
+                                         server->worstCaseExecTime - 1) / server->worstCaseExecTime);
+         server->serverDeadline = start + span;
+     }
+     
+     server->state = TASK_READY;
+     server->arrivalTime = job->releaseTime;
+     server->instanceExecutionTime = job->executionTime;
+     server->remainingExecutionTime = job->executionTime;
+     server->absoluteDeadline = server->serverDeadline;
+ }
+ 
+ // Charge `ticks` ticks of execution to a CBS server in one step
+ void serverConsumeBudget(Task *server, TickType_t ticks) {
+     if (server->kind != TASK_SERVER_CBS || ticks == 0) {
+         return;
+     }
+     
+     // An empty budget is recharged on the first tick, like a budget of one
+     TickType_t budget = server->serverBudget > 0 ? server->serverBudget : 1;
+     if (ticks < budget) {
+         server->serverBudget = budget - ticks;
+         return;
+     }
+     
+     // Budget exhausted: recharge and postpone the deadline by one period,
+     // once more for every further full budget consumed
+     TickType_t beyond = ticks - budget;
+     TickType_t recharges = 1 + beyond / server->worstCaseExecTime;
+     server->serverBudget = server->worstCaseExecTime - beyond % server->worstCaseExecTime;
+     server->serverDeadline += recharges * server->period;
+     server->absoluteDeadline = server->serverDeadline;
+ }
@@ -0,0 +1,17 @@
+/**
+ * aperiodic_server.h - Bandwidth servers for aperiodic jobs under EDF
+ */
+
+ #ifndef APERIODIC_SERVER_H
+ #define APERIODIC_SERVER_H
+ 
+ #include "FreeRTOS.h"
+ #include "task_set.h"
+ 
+ // Function prototypes
+ void serverJobArrival(Task *server, TickType_t currentTime);
+ void serverDispatchNextJob(Task *server, TickType_t currentTime);
+ void serverConsumeBudget(Task *server, TickType_t ticks);
+ unsigned int serverQueuedJobs(const Task *server);
+ 
+ #endif /* APERIODIC_SERVER_H */
@@ -0,0 +1,438 @@
+/**
+ * checkpoint.c - Simulation state snapshot and restore
+ *
+ * A checkpoint holds everything mainSchedulerLoop mutates: the runtime fields
+ * of every task (including trace positions, aperiodic server state and the
+ * response time histogram), the pending release events, the criticality
+ * mode, the power state, the thermal state, the scheduler statistics and the
+ * current simulation time. The static task parameters, execution times and
+ * arrival traces are not stored; instead a fingerprint of them is recorded
+ * so that a checkpoint is only restored on top of the same inputs it was
+ * taken from.
+ *
+ * All values are written as fixed-width little-endian integers so the file
+ * is compact and portable between hosts.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include "checkpoint.h"
+ 
+ // Low-level encoding helpers
+ static bool writeU32(FILE *file, uint32_t value) {
+     unsigned char bytes[4];
+     bytes[0] = (unsigned char)(value);
+     bytes[1] = (unsigned char)(value >> 8);
+     bytes[2] = (unsigned char)(value >> 16);
+     bytes[3] = (unsigned char)(value >> 24);
+     return fwrite(bytes, sizeof(bytes), 1, file) == 1;
+ }
+ 
+ static bool readU32(FILE *file, uint32_t *value) {
+     unsigned char bytes[4];
+     if (fread(bytes, sizeof(bytes), 1, file) != 1) {
+         return false;
+     }
+     *value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+              ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+     return true;
+ }
+ 
+ static bool writeFloat(FILE *file, float value) {
+     uint32_t bits;
+     memcpy(&bits, &value, sizeof(bits));
+     return writeU32(file, bits);
+ }
+ 
+ static bool readFloat(FILE *file, float *value) {
+     uint32_t bits;
+     if (!readU32(file, &bits)) {
+         return false;
+     }
+     memcpy(value, &bits, sizeof(bits));
+     return true;
+ }
+ 
+ static bool writeDouble(FILE *file, double value) {
+     uint64_t bits;
+     memcpy(&bits, &value, sizeof(bits));
+     return writeU32(file, (uint32_t)bits) && writeU32(file, (uint32_t)(bits >> 32));
+ }
+ 
+ static bool readDouble(FILE *file, double *value) {
+     uint32_t low, high;
+     if (!readU32(file, &low) || !readU32(file, &high)) {
+         return false;
+     }
+     uint64_t bits = (uint64_t)low | ((uint64_t)high << 32);
+     memcpy(value, &bits, sizeof(bits));
+     return true;
+ }
+ 
+ // FNV-1a over a 32-bit value
+ uint32_t fingerprintU32(uint32_t hash, uint32_t value) {
+     for (int i = 0; i < 4; i++) {
+         hash ^= (value >> (i * 8)) & 0xFF;
+         hash *= 16777619u;
+     }
+     return hash;
+ }
+ 
+ // Static task parameters only, without execution times or arrival traces
+ uint32_t fingerprintTaskParameters(uint32_t hash, const TaskSet *taskSet) {
+     hash = fingerprintU32(hash, (uint32_t)taskSet->count);
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         hash = fingerprintU32(hash, (uint32_t)task->id);
+         hash = fingerprintU32(hash, (uint32_t)task->kind);
+         hash = fingerprintU32(hash, task->period);
+         hash = fingerprintU32(hash, task->relativeDeadline);
+         hash = fingerprintU32(hash, task->worstCaseExecTime);
+         hash = fingerprintU32(hash, (uint32_t)task->criticality);
+         hash = fingerprintU32(hash, task->wcetHi);
+     }
+     
+     return hash;
+ }
+ 
+ uint32_t calculateTaskSetFingerprint(const TaskSet *taskSet) {
+     uint32_t hash = fingerprintTaskParameters(FINGERPRINT_SEED, taskSet);
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         for (int j = 0; j < MAX_INSTANCES; j++) {
+             hash = fingerprintU32(hash, task->actualExecutionTime[j]);
+         }
+         hash = fingerprintU32(hash, task->arrivalCount);
+         for (unsigned int j = 0; j < task->arrivalCount; j++) {
+             hash = fingerprintU32(hash, task->arrivals[j].releaseTime);
+             hash = fingerprintU32(hash, task->arrivals[j].executionTime);
+         }
+     }
+     
+     return hash;
+ }
+ 
+ static bool writeTaskRuntime(FILE *file, const Task *task) {
+     return writeU32(file, (uint32_t)task->state) &&
+            writeU32(file, task->nextArrivalTime) &&
+            writeU32(file, task->absoluteDeadline) &&
+            writeU32(file, task->remainingExecutionTime) &&
+            writeU32(file, task->arrivalTime) &&
+            writeU32(file, task->completionTime) &&
+            writeU32(file, task->instanceExecutionTime) &&
+            writeU32(file, task->releasePending ? 1 : 0) &&
+            writeU32(file, (uint32_t)task->currentInstance) &&
+            writeU32(file, task->nextArrival) &&
+            writeU32(file, task->nextServedJob) &&
+            writeU32(file, task->serverBudget) &&
+            writeU32(file, task->serverDeadline) &&
+            writeU32(file, task->instancesCompleted) &&
+            writeU32(file, task->deadlineMisses) &&
+            writeU32(file, task->totalResponseTime) &&
+            writeU32(file, task->maxResponseTime) &&
+            writeU32(file, task->virtualDeadline) &&
+            writeU32(file, task->jobsDropped);
+ }
+ 
+ static bool readTaskRuntime(FILE *file, Task *task) {
+     uint32_t state, releasePending, currentInstance;
+     
+     if (!readU32(file, &state) ||
+         !readU32(file, &task->nextArrivalTime) ||
+         !readU32(file, &task->absoluteDeadline) ||
+         !readU32(file, &task->remainingExecutionTime) ||
+         !readU32(file, &task->arrivalTime) ||
+         !readU32(file, &task->completionTime) ||
+         !readU32(file, &task->instanceExecutionTime) ||
+         !readU32(file, &releasePending) ||
+         !readU32(file, &currentInstance) ||
+         !readU32(file, &task->nextArrival) ||
+         !readU32(file, &task->nextServedJob) ||
+         !readU32(file, &task->serverBudget) ||
+         !readU32(file, &task->serverDeadline) ||
+         !readU32(file, &task->instancesCompleted) ||
+         !readU32(file, &task->deadlineMisses) ||
+         !readU32(file, &task->totalResponseTime) ||
+         !readU32(file, &task->maxResponseTime) ||
+         !readU32(file, &task->virtualDeadline) ||
+         !readU32(file, &task->jobsDropped)) {
+         return false;
+     }
+     
+     if (state > TASK_RUNNING || currentInstance >= MAX_INSTANCES ||
+         task->nextArrival > task->arrivalCount || task->nextServedJob > task->nextArrival) {
+         return false;
+     }
+     
+     task->state = (TaskState)state;
+     task->releasePending = (releasePending != 0);
+     task->currentInstance = (int)currentInstance;
+     return true;
+ }
+ 
+ // Only the non-empty buckets are stored
+ static bool writeHistogram(FILE *file, const Histogram *histogram) {
+     uint32_t used = 0;
+     for (unsigned int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+         used += histogram->counts[i] != 0;
+     }
+     
+     bool ok = writeU32(file, histogram->total) &&
+               writeU32(file, histogram->max) &&
+               writeU32(file, used);
+     for (unsigned int i = 0; ok && i < HISTOGRAM_BUCKETS; i++) {
+         if (histogram->counts[i] != 0) {
+             ok = writeU32(file, i) && writeU32(file, histogram->counts[i]);
+         }
+     }
+     
+     return ok;
+ }
+ 
+ static bool readHistogram(FILE *file, Histogram *histogram) {
+     uint32_t used;
+     memset(histogram, 0, sizeof(Histogram));
+     
+     if (!readU32(file, &histogram->total) || !readU32(file, &histogram->max) ||
+         !readU32(file, &used) || used > HISTOGRAM_BUCKETS) {
+         return false;
+     }
+     
+     for (uint32_t i = 0; i < used; i++) {
+         uint32_t bucket;
+         if (!readU32(file, &bucket) || bucket >= HISTOGRAM_BUCKETS ||
+             !readU32(file, &histogram->counts[bucket])) {
+             return false;
+         }
+     }
+     
+     return true;
+ }
+ 
+ static bool writeStats(FILE *file, const SchedulerStats *stats) {
+     bool ok = writeU32(file, stats->totalExecutionTime) &&
+               writeDouble(file, stats->energyConsumption) &&
+               writeU32(file, stats->dvfsTransitions) &&
+               writeU32(file, stats->dpmTransitions);
+     
+     for (int i = 0; ok && i < DVFS_LEVELS; i++) {
+         ok = writeU32(file, stats->timeAtFrequency[i]);
+     }
+     
+     return ok && writeU32(file, stats->timeInPowerDown);
+ }
+ 
+ static bool readStats(FILE *file, SchedulerStats *stats) {
+     double energy = 0.0;  // Stored at double precision whatever the accumulator type
+     bool ok = readU32(file, &stats->totalExecutionTime) &&
+               readDouble(file, &energy) &&
+               readU32(file, &stats->dvfsTransitions) &&
+               readU32(file, &stats->dpmTransitions);
+     
+     for (int i = 0; ok && i < DVFS_LEVELS; i++) {
+         ok = readU32(file, &stats->timeAtFrequency[i]);
+     }
+     stats->energyConsumption = energy;
+     
+     return ok && readU32(file, &stats->timeInPowerDown);
+ }
+ 
+ bool saveCheckpoint(const char *filename, const TaskSet *taskSet, const PowerState *powerState,
+                     const SchedulerStats *stats, const ThermalModel *thermal, TickType_t currentTime) {
+     // Write to a temporary file first so an interrupted save never
+     // clobbers the previous checkpoint
+     char tempFilename[512];
+     snprintf(tempFilename, sizeof(tempFilename), "%s.tmp", filename);
+     
+     FILE *file = fopen(tempFilename, "wb");
+     if (file == NULL) {
+         printf("Error opening checkpoint file: %s\n", tempFilename);
+         return false;
+     }
+     
+     // Header
+     bool ok = writeU32(file, CHECKPOINT_MAGIC) &&
+               writeU32(file, CHECKPOINT_VERSION) &&
+               writeU32(file, taskSet->fingerprint) &&
+               writeU32(file, (uint32_t)taskSet->count) &&
+               writeU32(file, currentTime);
+     
+     // Power state
+     ok = ok && writeFloat(file, powerState->frequencyLevel) &&
+                writeU32(file, powerState->isDPMActive ? 1 : 0) &&
+                writeU32(file, powerState->isBoosted ? 1 : 0) &&
+                writeU32(file, (uint32_t)powerState->frequencyCap);
+     
+     // Thermal state; the network constants are derived again on load
+     ok = ok && writeDouble(file, thermal->rise[0]) &&
+                writeDouble(file, thermal->rise[1]) &&
+                writeDouble(file, thermal->power) &&
+                writeU32(file, thermal->lastUpdateTime) &&
+                writeU32(file, thermal->startTime) &&
+                writeU32(file, thermal->nextEventTime) &&
+                writeU32(file, thermal->throttled ? 1 : 0) &&
+                writeDouble(file, thermal->peakTemperature) &&
+                writeDouble(file, thermal->temperatureIntegral) &&
+                writeU32(file, thermal->throttleEvents) &&
+                writeU32(file, thermal->timeThrottled) &&
+                writeU32(file, thermal->throttleStartTime);
+     
+     // Criticality mode
+     const CriticalityState *criticality = &taskSet->criticality;
+     ok = ok && writeU32(file, (uint32_t)criticality->mode) &&
+                writeU32(file, criticality->modeSwitches) &&
+                writeU32(file, criticality->modeSwitchTime) &&
+                writeU32(file, criticality->timeInHighMode);
+     
+     // Scheduler statistics
+     ok = ok && writeStats(file, stats);
+     
+     // Task runtime state
+     for (int i = 0; ok && i < taskSet->count; i++) {
+         ok = writeTaskRuntime(file, &taskSet->tasks[i]) &&
+              writeHistogram(file, &taskSet->responseTimes[i]);
+     }
+     
+     // Pending release events
+     ok = ok && writeU32(file, (uint32_t)taskSet->releaseQueue.count);
+     for (int i = 0; ok && i < taskSet->releaseQueue.count; i++) {
+         ok = writeU32(file, taskSet->releaseQueue.events[i].time) &&
+              writeU32(file, (uint32_t)taskSet->releaseQueue.events[i].taskIndex);
+     }
+     
+     if (fclose(file) != 0) {
+         ok = false;
+     }
+     
+     if (!ok || rename(tempFilename, filename) != 0) {
+         printf("Error writing checkpoint file: %s\n", filename);
+         remove(tempFilename);
+         return false;
+     }
+     
+     return true;
+ }
+ 
+ bool loadCheckpoint(const char *filename, TaskSet *taskSet, PowerState *powerState,
+                     SchedulerStats *stats, ThermalModel *thermal, TickType_t *currentTime) {
+     FILE *file = fopen(filename, "rb");
+     if (file == NULL) {
+         printf("Error opening checkpoint file: %s\n", filename);
+         return false;
+     }
+     
+     uint32_t magic, version, fingerprint, count, dpmActive, boosted, frequencyCap, throttled, mode;
+     if (!readU32(file, &magic) || !readU32(file, &version) ||
+         !readU32(file, &fingerprint) || !readU32(file, &count)) {
+         printf("Error reading checkpoint header from %s\n", filename);
+         fclose(file);
+         return false;
+     }
+     
+     if (magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION) {
+         printf("Error: %s is not a version %d checkpoint file.\n", filename, CHECKPOINT_VERSION);
+         fclose(file);
+         return false;
+     }
+     
+     if (count != (uint32_t)taskSet->count || fingerprint != taskSet->fingerprint) {
+         printf("Error: checkpoint %s was taken from a different task set.\n", filename);
+         fclose(file);
+         return false;
+     }
+     
+     // Restore into copies so a truncated file leaves the caller's state untouched
+     PowerState restoredPowerState;
+     SchedulerStats restoredStats;
+     CriticalityState restoredCriticality = taskSet->criticality;
+     ThermalModel restoredThermal = *thermal;
+     TickType_t restoredTime;
+     memset(&restoredStats, 0, sizeof(SchedulerStats));
+     
+     bool ok = readU32(file, &restoredTime) &&
+               readFloat(file, &restoredPowerState.frequencyLevel) &&
+               readU32(file, &dpmActive) &&
+               readU32(file, &boosted) &&
+               readU32(file, &frequencyCap) && frequencyCap < DVFS_LEVELS &&
+               readDouble(file, &restoredThermal.rise[0]) &&
+               readDouble(file, &restoredThermal.rise[1]) &&
+               readDouble(file, &restoredThermal.power) &&
+               readU32(file, &restoredThermal.lastUpdateTime) &&
+               readU32(file, &restoredThermal.startTime) &&
+               readU32(file, &restoredThermal.nextEventTime) &&
+               readU32(file, &throttled) &&
+               readDouble(file, &restoredThermal.peakTemperature) &&
+               readDouble(file, &restoredThermal.temperatureIntegral) &&
+               readU32(file, &restoredThermal.throttleEvents) &&
+               readU32(file, &restoredThermal.timeThrottled) &&
+               readU32(file, &restoredThermal.throttleStartTime) &&
+               readU32(file, &mode) && mode <= CRITICALITY_HI &&
+               readU32(file, &restoredCriticality.modeSwitches) &&
+               readU32(file, &restoredCriticality.modeSwitchTime) &&
+               readU32(file, &restoredCriticality.timeInHighMode) &&
+               readStats(file, &restoredStats);
+     restoredPowerState.isDPMActive = (dpmActive != 0);
+     restoredPowerState.isBoosted = (boosted != 0);
+     restoredPowerState.frequencyCap = (int)frequencyCap;
+     restoredThermal.throttled = (throttled != 0);
+     restoredCriticality.mode = (Criticality)mode;
+     
+     Task *restoredTasks = malloc(sizeof(Task) * taskSet->count);
+     if (restoredTasks == NULL) {
+         printf("Error allocating memory for checkpoint restore.\n");
+         fclose(file);
+         return false;
+     }
+     memcpy(restoredTasks, taskSet->tasks, sizeof(Task) * taskSet->count);
+     
+     Histogram *restoredHistograms = malloc(sizeof(Histogram) * taskSet->count);
+     if (restoredHistograms == NULL) {
+         printf("Error allocating memory for checkpoint restore.\n");
+         free(restoredTasks);
+         fclose(file);
+         return false;
+     }
+     
+     for (int i = 0; ok && i < taskSet->count; i++) {
+         ok = readTaskRuntime(file, &restoredTasks[i]) &&
+              readHistogram(file, &restoredHistograms[i]);
+     }
+     
+     // The heap array is stored as-is, so its ordering is preserved
+     EventQueue restoredQueue;
+     uint32_t eventCount = 0;
+     eventQueueInit(&restoredQueue);
+     ok = ok && readU32(file, &eventCount) && eventCount <= EVENT_QUEUE_CAPACITY;
+     for (uint32_t i = 0; ok && i < eventCount; i++) {
+         uint32_t taskIndex;
+         ok = readU32(file, &restoredQueue.events[i].time) &&
+              readU32(file, &taskIndex) && taskIndex < (uint32_t)taskSet->count;
+         restoredQueue.events[i].taskIndex = (int)taskIndex;
+     }
+     restoredQueue.count = ok ? (int)eventCount : 0;
+     
+     fclose(file);
+     
+     if (!ok) {
+         printf("Error: checkpoint file %s is truncated or corrupt.\n", filename);
+         free(restoredTasks);
+         free(restoredHistograms);
+         return false;
+     }
+     
+     memcpy(taskSet->tasks, restoredTasks, sizeof(Task) * taskSet->count);
+     memcpy(taskSet->responseTimes, restoredHistograms, sizeof(Histogram) * taskSet->count);
+     free(restoredTasks);
+     free(restoredHistograms);
+     taskSet->releaseQueue = restoredQueue;
+     taskSet->criticality = restoredCriticality;
+     *powerState = restoredPowerState;
+     *thermal = restoredThermal;
+     *stats = restoredStats;
+     *currentTime = restoredTime;
+     
+     printf("Restored checkpoint from %s at time %u\n", filename, (unsigned int)restoredTime);
+     return true;
+ }
@@ -0,0 +1,29 @@
+/**
+ * checkpoint.h - Simulation state snapshot and restore
+ */
+
+ #ifndef CHECKPOINT_H
+ #define CHECKPOINT_H
+ 
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "scheduler.h"
+ #include "task_set.h"
+ #include "thermal.h"
+ 
+ // Checkpoint file format identification
+ #define CHECKPOINT_MAGIC   0x43535452u  // "RTSC" in little-endian byte order
+ #define CHECKPOINT_VERSION 1
+ 
+ #define FINGERPRINT_SEED 2166136261u  // FNV-1a offset basis
+ 
+ // Function prototypes
+ uint32_t fingerprintU32(uint32_t hash, uint32_t value);
+ uint32_t fingerprintTaskParameters(uint32_t hash, const TaskSet *taskSet);
+ uint32_t calculateTaskSetFingerprint(const TaskSet *taskSet);
+ bool saveCheckpoint(const char *filename, const TaskSet *taskSet, const PowerState *powerState,
+                     const SchedulerStats *stats, const ThermalModel *thermal, TickType_t currentTime);
+ bool loadCheckpoint(const char *filename, TaskSet *taskSet, PowerState *powerState,
+                     SchedulerStats *stats, ThermalModel *thermal, TickType_t *currentTime);
+ 
+ #endif /* CHECKPOINT_H */
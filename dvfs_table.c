@@ -0,0 +1,204 @@
+/**
+ * dvfs_table.c - Precomputed DVFS decision tables
+ *
+ * makeDVFSDecision maps a (remaining work, time to deadline) pair to the
+ * lowest frequency level covering their ratio. With tables enabled the
+ * mapping is precomputed so that selection is an integer lookup:
+ *
+ *  - Each task gets a direct table indexed by work and time to deadline that
+ *    covers every pair its own jobs can produce. The tables share one pool
+ *    whose size is capped by a budget; the smallest tables are placed first
+ *    so that as many tasks as possible are covered.
+ *  - Pairs outside a task's table (tasks that did not fit in the budget, or
+ *    server deadlines beyond the relative deadline) use a shared table
+ *    indexed by the ratio rounded up to a multiple of 1/ratioSteps.
+ *    ratioSteps is the smallest resolution at which every frequency level is
+ *    exact, so the shared table gives the same answer as the float path. If
+ *    no such resolution exists it can only choose a higher level.
+ *
+ * Tables are rebuilt only when the task parameters or the level table change.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <math.h>
+ #include "dvfs_table.h"
+ 
+ // Shared ratio table; entry ratioSteps + 1 holds ratios above 1.0
+ static unsigned char ratioTable[DVFS_RATIO_STEPS + 2];
+ static unsigned int ratioSteps = 0;  // 0 while tables are disabled
+ static float tabulatedLevels[DVFS_LEVELS];
+ 
+ // Smallest resolution at which every frequency level is a whole number of steps
+ static unsigned int findExactRatioSteps(void) {
+     for (unsigned int steps = 1; steps <= DVFS_RATIO_STEPS; steps++) {
+         bool exact = true;
+         for (int i = 0; i < DVFS_LEVELS && exact; i++) {
+             float scaled = getFrequencyLevel(i) * steps;
+             exact = fabsf(scaled - roundf(scaled)) < 1e-3f;
+         }
+         if (exact) {
+             return steps;
+         }
+     }
+     return DVFS_RATIO_STEPS;
+ }
+ 
+ static bool levelTableChanged(void) {
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         if (tabulatedLevels[i] != getFrequencyLevel(i)) {
+             return true;
+         }
+     }
+     return false;
+ }
+ 
+ static void buildRatioTable(void) {
+     ratioSteps = findExactRatioSteps();
+     
+     // Bucket q holds ratios in ((q - 1) / steps, q / steps]
+     for (unsigned int q = 0; q <= ratioSteps + 1; q++) {
+         ratioTable[q] = (unsigned char)selectFrequencyIndex(calculateRequiredFrequency(q, ratioSteps));
+     }
+     
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         tabulatedLevels[i] = getFrequencyLevel(i);
+     }
+ }
+ 
+ // Largest work any job of the task can carry
+ static TickType_t maximumJobWork(const Task *task) {
+     TickType_t work = task->worstCaseExecTime;
+     
+     for (int i = 0; i < MAX_INSTANCES; i++) {
+         if (task->actualExecutionTime[i] > work) {
+             work = task->actualExecutionTime[i];
+         }
+     }
+     for (unsigned int i = 0; i < task->arrivalCount; i++) {
+         if (task->arrivals[i].executionTime > work) {
+             work = task->arrivals[i].executionTime;
+         }
+     }
+     
+     return work;
+ }
+ 
+ static size_t tableBytes(TickType_t work, TickType_t deadline) {
+     return ((size_t)work + 1) * ((size_t)deadline + 1);
+ }
+ 
+ // Table dimensions of one task, measured once per build
+ typedef struct {
+     int taskIndex;
+     TickType_t maxWork;
+     size_t bytes;
+ } TableExtent;
+ 
+ static int compareTableSize(const void *a, const void *b) {
+     const TableExtent *extentA = (const TableExtent *)a;
+     const TableExtent *extentB = (const TableExtent *)b;
+     
+     if (extentA->bytes != extentB->bytes) {
+         return extentA->bytes < extentB->bytes ? -1 : 1;
+     }
+     return extentA->taskIndex - extentB->taskIndex;
+ }
+ 
+ bool buildDVFSTables(TaskSet *taskSet, size_t budget) {
+     DVFSTablePool *tables = &taskSet->dvfsTables;
+     uint32_t signature = taskSet->fingerprint;
+     
+     if (ratioSteps == 0 || levelTableChanged()) {
+         buildRatioTable();
+         tables->valid = false;
+     }
+     
+     // Nothing to do if the task set is the one the tables were built from
+     if (tables->valid && tables->signature == signature && tables->budget == budget) {
+         return true;
+     }
+     
+     free(tables->pool);
+     memset(tables, 0, sizeof(DVFSTablePool));
+     
+     // Place the smallest tables first until the budget is used up
+     TableExtent extents[MAX_TASKS];
+     size_t size = 0;
+     for (int i = 0; i < taskSet->count; i++) {
+         Task *task = &taskSet->tasks[i];
+         extents[i].taskIndex = i;
+         extents[i].maxWork = maximumJobWork(task);
+         extents[i].bytes = tableBytes(extents[i].maxWork, task->relativeDeadline);
+         task->dvfsTable = NULL;
+     }
+     qsort(extents, taskSet->count, sizeof(TableExtent), compareTableSize);
+     
+     int tabulated = 0;
+     for (; tabulated < taskSet->count; tabulated++) {
+         if (extents[tabulated].bytes > budget - size) {
+             break;
+         }
+         size += extents[tabulated].bytes;
+     }
+     
+     if (size > 0) {
+         tables->pool = malloc(size);
+         if (tables->pool == NULL) {
+             printf("Error allocating memory for DVFS decision tables.\n");
+             return false;
+         }
+     }
+     
+     size_t offset = 0;
+     for (int k = 0; k < tabulated; k++) {
+         Task *task = &taskSet->tasks[extents[k].taskIndex];
+         TickType_t maxWork = extents[k].maxWork;
+         unsigned char *table = tables->pool + offset;
+         
+         for (TickType_t work = 0; work <= maxWork; work++) {
+             for (TickType_t timeToDeadline = 0; timeToDeadline <= task->relativeDeadline; timeToDeadline++) {
+                 table[(size_t)work * (task->relativeDeadline + 1) + timeToDeadline] =
+                     (unsigned char)selectFrequencyIndex(calculateRequiredFrequency(work, timeToDeadline));
+             }
+         }
+         
+         task->dvfsTable = table;
+         task->dvfsTableWork = maxWork;
+         task->dvfsTableDeadline = task->relativeDeadline;
+         offset += extents[k].bytes;
+     }
+     
+     tables->size = size;
+     tables->budget = budget;
+     tables->signature = signature;
+     tables->valid = true;
+     
+     printf("DVFS decision tables: %d of %d tasks tabulated in %zu bytes (budget %zu), ratio steps 1/%u\n",
+            tabulated, taskSet->count, size, budget, ratioSteps);
+     return true;
+ }
+ 
+ int lookupFrequencyIndex(const Task *task, TickType_t work, TickType_t timeToDeadline) {
+     if (ratioSteps == 0) {
+         return -1;
+     }
+     
+     if (task->dvfsTable != NULL && work <= task->dvfsTableWork && timeToDeadline <= task->dvfsTableDeadline) {
+         return task->dvfsTable[(size_t)work * (task->dvfsTableDeadline + 1) + timeToDeadline];
+     }
+     
+     // Shared table: round the ratio up to the next step
+     unsigned int bucket = ratioSteps;
+     if (timeToDeadline > 0) {
+         uint64_t scaledWork = (uint64_t)work * ratioSteps;
+         if (scaledWork > (uint64_t)ratioSteps * timeToDeadline) {
+             bucket = ratioSteps + 1;
+         } else {
+             bucket = (unsigned int)((scaledWork + timeToDeadline - 1) / timeToDeadline);
+         }
+     }
+     
+     return ratioTable[bucket];
+ }
@@ -0,0 +1,19 @@
+/**
+ * dvfs_table.h - Precomputed DVFS decision tables
+ */
+
+ #ifndef DVFS_TABLE_H
+ #define DVFS_TABLE_H
+ 
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "task_set.h"
+ 
+ #define DVFS_TABLE_DEFAULT_BUDGET (256 * 1024)  // Bytes shared by all per-task tables
+ #define DVFS_RATIO_STEPS 1000                   // Finest resolution of the shared ratio table
+ 
+ // Function prototypes
+ bool buildDVFSTables(TaskSet *taskSet, size_t budget);
+ int lookupFrequencyIndex(const Task *task, TickType_t work, TickType_t timeToDeadline);
+ 
+ #endif /* DVFS_TABLE_H */
@@ -0,0 +1,86 @@
+/**
+ * event_queue.c - Time-ordered release event queue
+ *
+ * Push and pop are O(log n) in the number of pending releases, so the
+ * cost of driving releases no longer depends on how many ticks elapse
+ * between them or how long the arrival traces are.
+ */
+
+ #include <stdio.h>
+ #include "event_queue.h"
+ 
+ // Events are ordered by time, then by task index so that simultaneous
+ // releases happen in task set order
+ static bool eventBefore(const ReleaseEvent *a, const ReleaseEvent *b) {
+     if (a->time != b->time) {
+         return a->time < b->time;
+     }
+     return a->taskIndex < b->taskIndex;
+ }
+ 
+ void eventQueueInit(EventQueue *queue) {
+     queue->count = 0;
+ }
+ 
+ bool eventQueuePush(EventQueue *queue, TickType_t time, int taskIndex) {
+     if (queue->count >= EVENT_QUEUE_CAPACITY) {
+         printf("Warning: Release event queue full. Dropping release of task index %d.\n", taskIndex);
+         return false;
+     }
+     
+     // Sift the new event up from the bottom of the heap
+     int child = queue->count++;
+     ReleaseEvent event = { time, taskIndex };
+     
+     while (child > 0) {
+         int parent = (child - 1) / 2;
+         if (!eventBefore(&event, &queue->events[parent])) {
+             break;
+         }
+         queue->events[child] = queue->events[parent];
+         child = parent;
+     }
+     
+     queue->events[child] = event;
+     return true;
+ }
+ 
+ bool eventQueuePeek(const EventQueue *queue, ReleaseEvent *event) {
+     if (queue->count == 0) {
+         return false;
+     }
+     
+     *event = queue->events[0];
+     return true;
+ }
+ 
+ bool eventQueuePop(EventQueue *queue, ReleaseEvent *event) {
+     if (queue->count == 0) {
+         return false;
+     }
+     
+     *event = queue->events[0];
+     ReleaseEvent last = queue->events[--queue->count];
+     
+     // Sift the last event down from the root
+     int parent = 0;
+     while (true) {
+         int child = 2 * parent + 1;
+         if (child >= queue->count) {
+             break;
+         }
+         if (child + 1 < queue->count && eventBefore(&queue->events[child + 1], &queue->events[child])) {
+             child++;
+         }
+         if (!eventBefore(&queue->events[child], &last)) {
+             break;
+         }
+         queue->events[parent] = queue->events[child];
+         parent = child;
+     }
+     
+     if (queue->count > 0) {
+         queue->events[parent] = last;
+     }
+     return true;
+ }
@@ -0,0 +1,32 @@
+/**
+ * event_queue.h - Time-ordered release event queue
+ */
+
+ #ifndef EVENT_QUEUE_H
+ #define EVENT_QUEUE_H
+ 
+ #include "FreeRTOS.h"
+ 
+ // Each task has at most one pending release event, so the queue never
+ // holds more events than there are tasks
+ #define EVENT_QUEUE_CAPACITY 50
+ 
+ // A pending release of a task instance (or an aperiodic job arrival)
+ typedef struct {
+     TickType_t time;  // Absolute release time
+     int taskIndex;    // Index into TaskSet.tasks
+ } ReleaseEvent;
+ 
+ // Binary min-heap ordered by release time
+ typedef struct {
+     ReleaseEvent events[EVENT_QUEUE_CAPACITY];
+     int count;
+ } EventQueue;
+ 
+ // Function prototypes
+ void eventQueueInit(EventQueue *queue);
+ bool eventQueuePush(EventQueue *queue, TickType_t time, int taskIndex);
+ bool eventQueuePeek(const EventQueue *queue, ReleaseEvent *event);
+ bool eventQueuePop(EventQueue *queue, ReleaseEvent *event);
+ 
+ #endif /* EVENT_QUEUE_H */
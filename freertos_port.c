@@ -0,0 +1,357 @@
+/**
+ * freertos_port.c - Host-side stand-in kernel for the FreeRTOS API subset
+ *
+ * Implements the tick count, task delay, software timer, critical section
+ * and tickless idle APIs on top of POSIX threads so that the runtime mode
+ * can be exercised on a development host. A dedicated thread plays the role
+ * of the tick interrupt: every 1/configTICK_RATE_HZ seconds it increments
+ * the tick count, calls vApplicationTickHook, services expired timers and
+ * wakes a delayed task.
+ *
+ * The calling thread of vTaskStartScheduler is the single application task.
+ * A task woken by the tick always runs until it blocks again before the next
+ * tick is taken, as it would on a target where its work fits in a tick. A
+ * host thread can be descheduled for longer than a tick; the tick is then
+ * held back and catches up afterwards, so host runs stay repeatable.
+ */
+
+ #define _POSIX_C_SOURCE 200809L
+ 
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <time.h>
+ #include <pthread.h>
+ #include "FreeRTOS.h"
+ #include "task.h"
+ #include "timers.h"
+ 
+ #define NS_PER_SEC 1000000000LL
+ #define TICK_PERIOD_NS (NS_PER_SEC / configTICK_RATE_HZ)
+ 
+ // Software timer control block
+ typedef struct {
+     bool inUse;
+     bool active;
+     const char *name;
+     TickType_t period;
+     BaseType_t autoReload;
+     void *timerID;
+     TimerCallbackFunction_t callback;
+     TickType_t expiryTime;
+ } PortTimer;
+ 
+ // Kernel state, guarded by kernelMutex
+ static pthread_mutex_t kernelMutex = PTHREAD_MUTEX_INITIALIZER;
+ static pthread_cond_t tickCondition = PTHREAD_COND_INITIALIZER;    // Delayed task wake-up
+ static pthread_cond_t blockedCondition;                            // Application task blocked
+ static pthread_t tickThread;
+ static volatile TickType_t tickCount = 0;
+ static bool schedulerRunning = false;
+ static bool ticksSuppressed = false;
+ static bool taskBlocked = false;
+ static TickType_t delayedWakeTime = 0;
+ static bool taskDelayed = false;
+ static struct timespec nextTickAt;
+ static int64_t suppressedUntilNs = 0;  // Last tick boundary covered by tickless idle
+ 
+ // Critical sections exclude the tick thread, like masking the tick interrupt
+ static pthread_mutex_t criticalMutex = PTHREAD_MUTEX_INITIALIZER;
+ 
+ static PortTimer timers[configTIMER_QUEUE_LENGTH];
+ static PortTickStats tickStats;
+ 
+ static int64_t timespecToNs(const struct timespec *ts) {
+     return (int64_t)ts->tv_sec * NS_PER_SEC + ts->tv_nsec;
+ }
+ 
+ static struct timespec nsToTimespec(int64_t ns) {
+     struct timespec ts;
+     ts.tv_sec = ns / NS_PER_SEC;
+     ts.tv_nsec = ns % NS_PER_SEC;
+     return ts;
+ }
+ 
+ static int64_t monotonicNowNs(void) {
+     struct timespec now;
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return timespecToNs(&now);
+ }
+ 
+ // Rearm or stop expired timers and return them; called with criticalMutex
+ // held and kernelMutex released. The callbacks are run by the caller once
+ // criticalMutex is released, so they may use the timer API themselves.
+ static int collectExpiredTimers(TickType_t now, PortTimer **expired) {
+     int count = 0;
+     
+     for (int i = 0; i < configTIMER_QUEUE_LENGTH; i++) {
+         PortTimer *timer = &timers[i];
+         if (!timer->inUse || !timer->active || now < timer->expiryTime) {
+             continue;
+         }
+         
+         if (timer->autoReload == pdTRUE) {
+             timer->expiryTime += timer->period;
+         } else {
+             timer->active = false;
+         }
+         expired[count++] = timer;
+     }
+     
+     return count;
+ }
+ 
+ static void *tickThreadMain(void *argument) {
+     (void)argument;
+     
+     pthread_mutex_lock(&kernelMutex);
+     while (schedulerRunning) {
+         // Let a freshly woken task run to its next block
+         while (schedulerRunning && !taskBlocked) {
+             pthread_cond_wait(&blockedCondition, &kernelMutex);
+         }
+         
+         // Wait for the next tick boundary
+         struct timespec wakeAt = nextTickAt;
+         pthread_mutex_unlock(&kernelMutex);
+         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeAt, NULL);
+         pthread_mutex_lock(&kernelMutex);
+         
+         // Boundaries covered by tickless idle were already stepped over
+         if (!schedulerRunning || ticksSuppressed || timespecToNs(&wakeAt) <= suppressedUntilNs) {
+             if (timespecToNs(&nextTickAt) <= timespecToNs(&wakeAt)) {
+                 nextTickAt = nsToTimespec(timespecToNs(&wakeAt) + TICK_PERIOD_NS);
+             }
+             continue;
+         }
+         nextTickAt = nsToTimespec(timespecToNs(&wakeAt) + TICK_PERIOD_NS);
+         
+         // Tick interrupt: the hook runs and timers expire with the application masked out
+         pthread_mutex_unlock(&kernelMutex);
+         pthread_mutex_lock(&criticalMutex);
+         int64_t tickStart = monotonicNowNs();
+         
+         pthread_mutex_lock(&kernelMutex);
+         TickType_t now = ++tickCount;
+         pthread_mutex_unlock(&kernelMutex);
+         
+         vApplicationTickHook();
+         PortTimer *expired[configTIMER_QUEUE_LENGTH];
+         int expiredCount = collectExpiredTimers(now, expired);
+         
+         int64_t tickCost = monotonicNowNs() - tickStart;
+         pthread_mutex_unlock(&criticalMutex);
+         
+         // Callbacks run outside the interrupt, as in the timer service task
+         for (int i = 0; i < expiredCount; i++) {
+             expired[i]->callback((TimerHandle_t)expired[i]);
+         }
+         pthread_mutex_lock(&kernelMutex);
+         
+         tickStats.ticksProcessed++;
+         tickStats.tickTotalNs += (uint64_t)tickCost;
+         if ((uint64_t)tickCost > tickStats.tickMaxNs) {
+             tickStats.tickMaxNs = (uint64_t)tickCost;
+         }
+         
+         // O(1) wake-up check for the delayed task
+         if (taskDelayed && now >= delayedWakeTime) {
+             taskDelayed = false;
+             taskBlocked = false;
+             pthread_cond_broadcast(&tickCondition);
+         }
+     }
+     pthread_mutex_unlock(&kernelMutex);
+     
+     return NULL;
+ }
+ 
+ void vTaskStartScheduler(void) {
+     pthread_mutex_lock(&kernelMutex);
+     if (schedulerRunning) {
+         pthread_mutex_unlock(&kernelMutex);
+         return;
+     }
+     
+     pthread_cond_init(&blockedCondition, NULL);
+     
+     memset(&tickStats, 0, sizeof(tickStats));
+     schedulerRunning = true;
+     taskBlocked = false;
+     nextTickAt = nsToTimespec(monotonicNowNs() + TICK_PERIOD_NS);
+     pthread_mutex_unlock(&kernelMutex);
+     
+     if (pthread_create(&tickThread, NULL, tickThreadMain, NULL) != 0) {
+         printf("Error starting tick thread.\n");
+         pthread_mutex_lock(&kernelMutex);
+         schedulerRunning = false;
+         pthread_mutex_unlock(&kernelMutex);
+     }
+ }
+ 
+ void vTaskEndScheduler(void) {
+     pthread_mutex_lock(&kernelMutex);
+     if (!schedulerRunning) {
+         pthread_mutex_unlock(&kernelMutex);
+         return;
+     }
+     schedulerRunning = false;
+     pthread_cond_broadcast(&blockedCondition);
+     pthread_cond_broadcast(&tickCondition);
+     pthread_mutex_unlock(&kernelMutex);
+     
+     pthread_join(tickThread, NULL);
+     pthread_cond_destroy(&blockedCondition);
+ }
+ 
+ TickType_t xTaskGetTickCount(void) {
+     pthread_mutex_lock(&kernelMutex);
+     TickType_t now = tickCount;
+     pthread_mutex_unlock(&kernelMutex);
+     return now;
+ }
+ 
+ void vTaskDelay(const TickType_t xTicksToDelay) {
+     if (xTicksToDelay == 0) {
+         return;
+     }
+     
+     pthread_mutex_lock(&kernelMutex);
+     if (!schedulerRunning) {
+         pthread_mutex_unlock(&kernelMutex);
+         return;
+     }
+     delayedWakeTime = tickCount + xTicksToDelay;
+     taskDelayed = true;
+     taskBlocked = true;
+     pthread_cond_broadcast(&blockedCondition);
+     
+     while (schedulerRunning && taskDelayed) {
+         pthread_cond_wait(&tickCondition, &kernelMutex);
+     }
+     taskBlocked = false;
+     pthread_mutex_unlock(&kernelMutex);
+ }
+ 
+ void vTaskStepTick(const TickType_t xTicksToJump) {
+     pthread_mutex_lock(&kernelMutex);
+     tickCount += xTicksToJump;
+     pthread_mutex_unlock(&kernelMutex);
+ }
+ 
+ void vPortEnterCritical(void) {
+     pthread_mutex_lock(&criticalMutex);
+ }
+ 
+ void vPortExitCritical(void) {
+     pthread_mutex_unlock(&criticalMutex);
+ }
+ 
+ void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+     pthread_mutex_lock(&kernelMutex);
+     
+     // Never sleep past an armed timer
+     for (int i = 0; i < configTIMER_QUEUE_LENGTH; i++) {
+         if (timers[i].inUse && timers[i].active && timers[i].expiryTime > tickCount &&
+             timers[i].expiryTime - tickCount < xExpectedIdleTime) {
+             xExpectedIdleTime = timers[i].expiryTime - tickCount;
+         }
+     }
+     
+     if (xExpectedIdleTime < 2) {
+         // Not worth stopping the tick for
+         pthread_mutex_unlock(&kernelMutex);
+         vTaskDelay(xExpectedIdleTime);
+         return;
+     }
+     
+     // Stop the tick, sleep through the idle period, then step the tick count
+     // forward and restart the tick from the wake-up time
+     ticksSuppressed = true;
+     taskBlocked = true;
+     int64_t wakeAt = timespecToNs(&nextTickAt) + (int64_t)(xExpectedIdleTime - 1) * TICK_PERIOD_NS;
+     suppressedUntilNs = wakeAt;
+     pthread_cond_broadcast(&blockedCondition);
+     pthread_mutex_unlock(&kernelMutex);
+     
+     struct timespec wakeTime = nsToTimespec(wakeAt);
+     clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL);
+     
+     pthread_mutex_lock(&kernelMutex);
+     tickCount += xExpectedIdleTime;
+     tickStats.ticksSuppressed += xExpectedIdleTime;
+     nextTickAt = nsToTimespec(wakeAt + TICK_PERIOD_NS);
+     ticksSuppressed = false;
+     taskBlocked = false;
+     pthread_mutex_unlock(&kernelMutex);
+ }
+ 
+ void vPortGetTickStats(PortTickStats *pxStats) {
+     pthread_mutex_lock(&kernelMutex);
+     *pxStats = tickStats;
+     pthread_mutex_unlock(&kernelMutex);
+ }
+ 
+ TimerHandle_t xTimerCreate(const char * const pcTimerName,
+                           const TickType_t xTimerPeriod,
+                           const BaseType_t xAutoReload,
+                           void * const pvTimerID,
+                           TimerCallbackFunction_t pxCallbackFunction) {
+     if (xTimerPeriod == 0 || pxCallbackFunction == NULL) {
+         return NULL;
+     }
+     
+     TimerHandle_t handle = NULL;
+     pthread_mutex_lock(&criticalMutex);
+     for (int i = 0; i < configTIMER_QUEUE_LENGTH; i++) {
+         if (!timers[i].inUse) {
+             memset(&timers[i], 0, sizeof(PortTimer));
+             timers[i].inUse = true;
+             timers[i].name = pcTimerName;
+             timers[i].period = xTimerPeriod;
+             timers[i].autoReload = xAutoReload;
+             timers[i].timerID = pvTimerID;
+             timers[i].callback = pxCallbackFunction;
+             handle = (TimerHandle_t)&timers[i];
+             break;
+         }
+     }
+     pthread_mutex_unlock(&criticalMutex);
+     
+     return handle;
+ }
+ 
+ BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+     (void)xTicksToWait;  // Commands are applied immediately on the host
+     PortTimer *timer = (PortTimer *)xTimer;
+     if (timer == NULL || !timer->inUse) {
+         return pdFAIL;
+     }
+     
+     pthread_mutex_lock(&criticalMutex);
+     timer->expiryTime = xTaskGetTickCount() + timer->period;
+     timer->active = true;
+     pthread_mutex_unlock(&criticalMutex);
+     return pdPASS;
+ }
+ 
+ BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait) {
+     (void)xTicksToWait;
+     PortTimer *timer = (PortTimer *)xTimer;
+     if (timer == NULL || !timer->inUse) {
+         return pdFAIL;
+     }
+     
+     pthread_mutex_lock(&criticalMutex);
+     timer->active = false;
+     pthread_mutex_unlock(&criticalMutex);
+     return pdPASS;
+ }
+ 
+ void *pvTimerGetTimerID(const TimerHandle_t xTimer) {
+     return ((PortTimer *)xTimer)->timerID;
+ }
+ 
+ TickType_t xTimerGetExpiryTime(TimerHandle_t xTimer) {
+     return ((PortTimer *)xTimer)->expiryTime;
+ }
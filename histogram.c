@@ -0,0 +1,79 @@
+/**
+ * histogram.c - Log-linear histogram of tick counts
+ *
+ * Recording a value is constant time and the memory is fixed, however many
+ * jobs a run completes. Percentiles are reported as the largest value of
+ * the bucket they fall in (capped at the largest value recorded), so they
+ * are exact below HISTOGRAM_EXACT_LIMIT and at most 1/16 too high above it.
+ */
+
+ #include "histogram.h"
+ 
+ static unsigned int bucketIndex(TickType_t value) {
+     if (value < HISTOGRAM_EXACT_LIMIT) {
+         return value;
+     }
+     
+     unsigned int msb = HISTOGRAM_EXACT_BITS;
+     while ((value >> (msb + 1)) != 0) {
+         msb++;
+     }
+     
+     unsigned int subBucket = (value >> (msb - HISTOGRAM_SUB_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+     return HISTOGRAM_EXACT_LIMIT + (msb - HISTOGRAM_EXACT_BITS) * HISTOGRAM_SUB_BUCKETS + subBucket;
+ }
+ 
+ // Largest value that falls in a bucket
+ static TickType_t bucketUpperBound(unsigned int index) {
+     if (index < HISTOGRAM_EXACT_LIMIT) {
+         return index;
+     }
+     
+     unsigned int octave = (index - HISTOGRAM_EXACT_LIMIT) / HISTOGRAM_SUB_BUCKETS;
+     unsigned int subBucket = (index - HISTOGRAM_EXACT_LIMIT) % HISTOGRAM_SUB_BUCKETS;
+     unsigned int shift = HISTOGRAM_EXACT_BITS + octave - HISTOGRAM_SUB_BITS;
+     TickType_t low = (TickType_t)(HISTOGRAM_SUB_BUCKETS + subBucket) << shift;
+     return low + (((TickType_t)1 << shift) - 1);
+ }
+ 
+ void histogramRecord(Histogram *histogram, TickType_t value) {
+     histogram->counts[bucketIndex(value)]++;
+     histogram->total++;
+     if (value > histogram->max) {
+         histogram->max = value;
+     }
+ }
+ 
+ void histogramMerge(Histogram *into, const Histogram *from) {
+     for (unsigned int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+         into->counts[i] += from->counts[i];
+     }
+     into->total += from->total;
+     if (from->max > into->max) {
+         into->max = from->max;
+     }
+ }
+ 
+ TickType_t histogramPercentile(const Histogram *histogram, double percentile) {
+     if (histogram->total == 0) {
+         return 0;
+     }
+     
+     // Nearest-rank percentile
+     double exactRank = percentile / 100.0 * histogram->total;
+     uint32_t rank = (uint32_t)exactRank;
+     if (rank < exactRank || rank == 0) {
+         rank++;
+     }
+     
+     uint32_t seen = 0;
+     for (unsigned int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+         seen += histogram->counts[i];
+         if (seen >= rank) {
+             TickType_t value = bucketUpperBound(i);
+             return value < histogram->max ? value : histogram->max;
+         }
+     }
+     
+     return histogram->max;
+ }
@@ -0,0 +1,32 @@
+/**
+ * histogram.h - Log-linear histogram of tick counts
+ */
+
+ #ifndef HISTOGRAM_H
+ #define HISTOGRAM_H
+ 
+ #include <stdint.h>
+ #include "FreeRTOS.h"
+ 
+ // Values below HISTOGRAM_EXACT_LIMIT get a bucket each. Above it, every
+ // power of two is split into HISTOGRAM_SUB_BUCKETS buckets, so a bucket is
+ // never wider than 1/16 of the values it holds.
+ #define HISTOGRAM_EXACT_BITS  7
+ #define HISTOGRAM_EXACT_LIMIT (1u << HISTOGRAM_EXACT_BITS)
+ #define HISTOGRAM_SUB_BITS    4
+ #define HISTOGRAM_SUB_BUCKETS (1u << HISTOGRAM_SUB_BITS)
+ #define HISTOGRAM_BUCKETS     (HISTOGRAM_EXACT_LIMIT + (32 - HISTOGRAM_EXACT_BITS) * HISTOGRAM_SUB_BUCKETS)
+ 
+ // Histogram with a fixed bucket layout, so histograms can be merged
+ typedef struct {
+     uint32_t counts[HISTOGRAM_BUCKETS];
+     uint32_t total;     // Values recorded
+     TickType_t max;     // Largest value recorded
+ } Histogram;
+ 
+ // Function prototypes
+ void histogramRecord(Histogram *histogram, TickType_t value);
+ void histogramMerge(Histogram *into, const Histogram *from);
+ TickType_t histogramPercentile(const Histogram *histogram, double percentile);
+ 
+ #endif /* HISTOGRAM_H */
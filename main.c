@@ -17,21 +17,72 @@
  #include "scheduler.h"
  #include "power_manager.h"
  #include "task_set.h"
+ #include "checkpoint.h"
+ #include "aperiodic_server.h"
+ #include "rtos_runtime.h"
+ #include "offline_solver.h"
+ #include "dvfs_table.h"
+ #include "trace.h"
+ #include "mixed_criticality.h"
+ #include "thermal.h"
+ #include "results.h"
  
  // Global variables
  TaskSet taskSet;
  PowerState currentPowerState;
  SchedulerStats stats;
  FILE *outputFile;
+ FILE *traceFile = NULL;
+ TickType_t simulationStartTime = 0;
+ 
+ // Output locations (set from the command line)
+ const char *outputFilename = "output.txt";
+ const char *analysisFilename = "analysis.txt";
+ const char *traceFilename = NULL;       // Machine-readable trace for schedule_diff
+ const char *resultsFilename = NULL;     // Append-only result rows for sweeps
+ ResultsFormat resultsFormat = RESULTS_FORMAT_CSV;
+ 
+ // Checkpoint options (set from the command line)
+ const char *checkpointFilename = NULL;  // Where snapshots are written
+ const char *resumeFilename = NULL;      // Checkpoint to resume from
+ const char *arrivalsFilename = "input_arrivals.txt";  // Sporadic/aperiodic release trace
+ TickType_t checkpointInterval = 0;      // Snapshot every N ticks (0 = off)
+ TickType_t checkpointStopTime = 0;      // Snapshot at this tick and stop
+ bool checkpointStopEnabled = false;
+ bool stoppedAtCheckpoint = false;       // The run ended at --checkpoint-at
+ 
+ // Runtime mode: event-driven scheduler on the FreeRTOS API (host port)
+ bool runtimeMode = false;
+ RuntimeStats runtimeStats;
+ 
+ // Mixed-criticality options
+ LowCriticalityPolicy lowCriticalityPolicy = MC_DROP_LO;
+ bool useVirtualDeadlines = true;
+ bool boostOnModeSwitch = true;
+ 
+ // Precomputed DVFS decision tables
+ bool dvfsTableMode = false;
+ size_t dvfsTableBudget = DVFS_TABLE_DEFAULT_BUDGET;
+ 
+ // Thermal model driven by the power state
+ ThermalModel thermalModel;
+ bool thermalThrottling = true;
  
  // Function prototypes
+ bool parseArguments(int argc, char *argv[]);
  void initializeSystem(void);
  void mainSchedulerLoop(void);
  void analyzeResults(void);
+ void exportResults(void);
  
  int main(int argc, char *argv[]) {
      printf("Starting Real-time Scheduler with DVFS+DPM...\n");
      
+     // Parse command-line options
+     if (!parseArguments(argc, argv)) {
+         return 1;
+     }
+     
      // Initialize system components
      initializeSystem();
      
@@ -47,30 +98,187 @@
          return 1;
      }
      
+     // Load release traces for sporadic tasks and aperiodic servers
+     if (taskSetNeedsArrivalTrace(&taskSet) && !loadArrivalTrace(arrivalsFilename, &taskSet)) {
+         printf("Error loading arrival trace. Exiting.\n");
+         return 1;
+     }
+     
+     // Identifies the inputs to checkpoints, decision tables and results;
+     // hashed once, as the arrival trace may hold millions of records
+     taskSet.fingerprint = calculateTaskSetFingerprint(&taskSet);
+     
+     // Criticality mode, EDF-VD factor and LO-task policy
+     initializeMixedCriticality(&taskSet, lowCriticalityPolicy, useVirtualDeadlines, boostOnModeSwitch);
+     
+     // Queue the first release of every task
+     initializeReleaseQueue(&taskSet);
+     
+     // Precompute DVFS decisions if requested
+     if (dvfsTableMode && !buildDVFSTables(&taskSet, dvfsTableBudget)) {
+         printf("Error building DVFS decision tables. Exiting.\n");
+         return 1;
+     }
+     
+     // Die and heat sink start at ambient temperature
+     initializeThermalModel(&thermalModel, thermalThrottling, 0);
+     
+     // Restore a previous run's state if requested
+     if (resumeFilename != NULL &&
+         !loadCheckpoint(resumeFilename, &taskSet, &currentPowerState, &stats, &thermalModel, &simulationStartTime)) {
+         printf("Error resuming from checkpoint. Exiting.\n");
+         return 1;
+     }
+     
+     // A stop tick the loop never reaches would silently write no checkpoint
+     if (checkpointStopEnabled && (checkpointStopTime <= simulationStartTime ||
+                                   checkpointStopTime > calculateSimulationEndTime(&taskSet))) {
+         printf("Error: --checkpoint-at %u is outside the run (ticks %u to %u). Exiting.\n",
+                (unsigned int)checkpointStopTime, (unsigned int)simulationStartTime + 1,
+                (unsigned int)calculateSimulationEndTime(&taskSet));
+         return 1;
+     }
+     
      // Open output file
-     outputFile = fopen("output.txt", "w");
+     outputFile = fopen(outputFilename, "w");
      if (outputFile == NULL) {
          printf("Error opening output file. Exiting.\n");
          return 1;
      }
      
+     if (traceFilename != NULL) {
+         traceFile = openTraceFile(traceFilename);
+         if (traceFile == NULL) {
+             fclose(outputFile);
+             return 1;
+         }
+     }
+     
      // Run the scheduler
-     mainSchedulerLoop();
+     if (runtimeMode) {
+         runtimeSchedulerLoop(&taskSet, &currentPowerState, &stats, &thermalModel,
+                              outputFile, traceFile, &runtimeStats);
+         logRuntimeStats(stdout, &runtimeStats);
+     } else {
+         mainSchedulerLoop();
+     }
      
      // Close output file
      fclose(outputFile);
      
-     // Analyze results
-     analyzeResults();
+     // Bring the temperature up to the end of the last tick
+     advanceThermalModel(&thermalModel, stats.totalExecutionTime);
+     
+     // A warm-up prefix has no results; leave the previous analysis in place
+     if (stoppedAtCheckpoint) {
+         printf("Run stopped at the checkpoint; %s not written.\n", analysisFilename);
+     } else {
+         analyzeResults();
+         if (resultsFilename != NULL) {
+             exportResults();
+         }
+         if (traceFile != NULL) {
+             writeTraceMetrics(traceFile, &taskSet, &stats, &thermalModel);
+         }
+     }
+     
+     if (traceFile != NULL) {
+         fclose(traceFile);
+     }
+     
+     freeTaskSet(&taskSet);
      
      printf("Scheduling completed successfully.\n");
      return 0;
  }
  
+ bool parseArguments(int argc, char *argv[]) {
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         
+         if (strcmp(argv[i], "--checkpoint") == 0 && hasValue) {
+             checkpointFilename = argv[++i];
+         } else if (strcmp(argv[i], "--checkpoint-every") == 0 && hasValue) {
+             checkpointInterval = (TickType_t)strtoul(argv[++i], NULL, 10);
+         } else if (strcmp(argv[i], "--checkpoint-at") == 0 && hasValue) {
+             checkpointStopTime = (TickType_t)strtoul(argv[++i], NULL, 10);
+             checkpointStopEnabled = true;
+         } else if (strcmp(argv[i], "--resume") == 0 && hasValue) {
+             resumeFilename = argv[++i];
+         } else if (strcmp(argv[i], "--arrivals") == 0 && hasValue) {
+             arrivalsFilename = argv[++i];
+         } else if (strcmp(argv[i], "--runtime") == 0) {
+             runtimeMode = true;
+         } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+             outputFilename = argv[++i];
+         } else if (strcmp(argv[i], "--analysis") == 0 && hasValue) {
+             analysisFilename = argv[++i];
+         } else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+             traceFilename = argv[++i];
+         } else if (strcmp(argv[i], "--results") == 0 && hasValue) {
+             resultsFilename = argv[++i];
+         } else if (strcmp(argv[i], "--results-format") == 0 && hasValue) {
+             const char *format = argv[++i];
+             if (strcmp(format, "csv") == 0) {
+                 resultsFormat = RESULTS_FORMAT_CSV;
+             } else if (strcmp(format, "columnar") == 0) {
+                 resultsFormat = RESULTS_FORMAT_COLUMNAR;
+             } else {
+                 printf("Error: --results-format must be csv or columnar.\n");
+                 return false;
+             }
+         } else if (strcmp(argv[i], "--mc-policy") == 0 && hasValue) {
+             const char *policy = argv[++i];
+             if (strcmp(policy, "drop") == 0) {
+                 lowCriticalityPolicy = MC_DROP_LO;
+             } else if (strcmp(policy, "degrade") == 0) {
+                 lowCriticalityPolicy = MC_DEGRADE_LO;
+             } else {
+                 printf("Error: --mc-policy must be drop or degrade.\n");
+                 return false;
+             }
+         } else if (strcmp(argv[i], "--no-edf-vd") == 0) {
+             useVirtualDeadlines = false;
+         } else if (strcmp(argv[i], "--no-mc-boost") == 0) {
+             boostOnModeSwitch = false;
+         } else if (strcmp(argv[i], "--no-thermal-throttle") == 0) {
+             thermalThrottling = false;
+         } else if (strcmp(argv[i], "--dvfs-table") == 0) {
+             dvfsTableMode = true;
+         } else if (strcmp(argv[i], "--dvfs-table-budget") == 0 && hasValue) {
+             dvfsTableBudget = (size_t)strtoul(argv[++i], NULL, 10);
+             dvfsTableMode = true;
+         } else {
+             printf("Usage: %s [--checkpoint FILE] [--checkpoint-every TICKS] [--checkpoint-at TICK]\n"
+                    "          [--resume FILE] [--arrivals FILE] [--runtime]\n"
+                    "          [--dvfs-table] [--dvfs-table-budget BYTES]\n"
+                    "          [--output FILE] [--analysis FILE] [--trace FILE]\n"
+                    "          [--results FILE] [--results-format csv|columnar]\n"
+                    "          [--mc-policy drop|degrade] [--no-edf-vd] [--no-mc-boost]\n"
+                    "          [--no-thermal-throttle]\n", argv[0]);
+             return false;
+         }
+     }
+     
+     if (runtimeMode && (checkpointFilename != NULL || resumeFilename != NULL)) {
+         printf("Error: checkpointing is only supported by the simulation loop.\n");
+         return false;
+     }
+     
+     if ((checkpointInterval > 0 || checkpointStopEnabled) && checkpointFilename == NULL) {
+         printf("Error: --checkpoint-every and --checkpoint-at require --checkpoint FILE.\n");
+         return false;
+     }
+     
+     return true;
+ }
+ 
  void initializeSystem(void) {
      // Initialize power state
      currentPowerState.frequencyLevel = 1.0; // Start at max frequency
      currentPowerState.isDPMActive = false;
+     currentPowerState.isBoosted = false;
+     currentPowerState.frequencyCap = DVFS_LEVELS - 1;
      
      // Initialize stats
      memset(&stats, 0, sizeof(SchedulerStats));
@@ -80,22 +288,45 @@
  }
  
  void mainSchedulerLoop(void) {
-     TickType_t currentTime = 0;
+     TickType_t currentTime = simulationStartTime;
      TickType_t simulationEndTime = calculateSimulationEndTime(&taskSet);
      
      fprintf(outputFile, "Time | Running Task | Frequency | Power Mode | Slack | Decision\n");
      fprintf(outputFile, "----------------------------------------------------------\n");
      
      while (currentTime <= simulationEndTime) {
+         // Snapshot the state between ticks so a resumed run continues exactly here
+         if (checkpointFilename != NULL && currentTime != simulationStartTime) {
+             bool stopHere = checkpointStopEnabled && currentTime == checkpointStopTime;
+             bool periodic = checkpointInterval > 0 && currentTime % checkpointInterval == 0;
+             
+             if (stopHere || periodic) {
+                 saveCheckpoint(checkpointFilename, &taskSet, &currentPowerState, &stats, &thermalModel, currentTime);
+             }
+             if (stopHere) {
+                 printf("Checkpoint written to %s at time %u\n", checkpointFilename, (unsigned int)currentTime);
+                 stoppedAtCheckpoint = true;
+                 break;
+             }
+         }
+         
          // Check for new task arrivals
          checkForTaskArrivals(&taskSet, currentTime);
          
          // Get the highest priority ready task (EDF)
          Task *currentTask = getHighestPriorityTask(&taskSet);
          
+         // An idle instant ends HI mode
+         if (currentTask == NULL) {
+             checkForModeReturn(&taskSet, &currentPowerState, currentTime);
+         }
+         
          // Calculate slack
          TickType_t slack = calculateSystemSlack(&taskSet, currentTime);
          
+         // Throttling changes the cap before the decision, which respects it
+         updateThermalThrottle(&thermalModel, &currentPowerState, currentTime);
+         
          // Determine appropriate power management strategy
          PowerDecision decision;
          if (currentTask == NULL) {
@@ -109,12 +340,18 @@
          // Apply power management decision
          applyPowerDecision(&decision, &currentPowerState);
          
+         // Heat from the new power state
+         updateThermalModel(&thermalModel, &currentPowerState, currentTime);
+         
          // Update statistics
          updateStats(&stats, &currentPowerState, currentTask, currentTime);
          
          // Write to output file
          logSchedulerState(outputFile, currentTime, currentTask, 
                           currentPowerState, slack, decision);
+         if (traceFile != NULL) {
+             writeTraceState(traceFile, currentTime, currentTask, currentPowerState, slack, decision);
+         }
          
          // Execute current task (simulation)
          if (currentTask != NULL) {
@@ -126,11 +363,14 @@
          
          // Check for completed tasks
          checkForTaskCompletions(&taskSet, currentTime);
+         
+         // A HI job that exhausted its LO budget switches to HI mode
+         checkForBudgetOverruns(&taskSet, &currentPowerState, currentTime);
      }
  }
  
  void analyzeResults(void) {
-     FILE *analysisFile = fopen("analysis.txt", "w");
+     FILE *analysisFile = fopen(analysisFilename, "w");
      if (analysisFile == NULL) {
          printf("Error opening analysis file.\n");
          return;
@@ -156,10 +396,53 @@
      fprintf(analysisFile, "Time spent in power-down mode: %.2f%%\n", 
             (float)stats.timeInPowerDown / stats.totalExecutionTime * 100);
      
+     fprintf(analysisFile, "\n");
+     logThermalModel(analysisFile, &thermalModel);
+     
+     if (taskSet.criticality.enabled) {
+         fprintf(analysisFile, "\n");
+         logMixedCriticality(analysisFile, &taskSet, stats.totalExecutionTime);
+     }
+     
+     if (runtimeMode) {
+         fprintf(analysisFile, "\n");
+         logRuntimeStats(analysisFile, &runtimeStats);
+     }
+     
+     // Lower bound from the offline optimal frequency assignment
+     OfflineSolution optimum;
+     if (solveOptimalFrequencyAssignment(&taskSet, calculateSimulationEndTime(&taskSet) + 1, &optimum)) {
+         fprintf(analysisFile, "\n");
+         logOfflineSolution(analysisFile, &optimum, stats.energyConsumption);
+     }
+     
      // Task statistics
      fprintf(analysisFile, "\nTask Statistics:\n");
      for (int i = 0; i < taskSet.count; i++) {
+         if (isAperiodicServer(&taskSet.tasks[i])) {
+             Task *server = &taskSet.tasks[i];
+             fprintf(analysisFile, "Task %d (%s server, Qs=%u, Ts=%u):\n", server->id,
+                    server->kind == TASK_SERVER_TBS ? "TBS" : "CBS",
+                    (unsigned int)server->worstCaseExecTime, (unsigned int)server->period);
+             fprintf(analysisFile, "  - Aperiodic jobs completed: %u\n", server->instancesCompleted);
+             fprintf(analysisFile, "  - Aperiodic jobs still queued: %u\n", serverQueuedJobs(server));
+             fprintf(analysisFile, "  - Average response time: %.2f ticks\n",
+                    server->instancesCompleted > 0 ?
+                    (float)server->totalResponseTime / server->instancesCompleted : 0);
+             fprintf(analysisFile, "  - Maximum response time: %u ticks\n", (unsigned int)server->maxResponseTime);
+             continue;
+         }
+         
          fprintf(analysisFile, "Task %d:\n", taskSet.tasks[i].id);
+         if (taskSet.criticality.enabled) {
+             const Task *task = &taskSet.tasks[i];
+             if (task->criticality == CRITICALITY_HI) {
+                 fprintf(analysisFile, "  - Criticality: HI (C(LO)=%u, C(HI)=%u)\n",
+                        (unsigned int)task->worstCaseExecTime, (unsigned int)task->wcetHi);
+             } else {
+                 fprintf(analysisFile, "  - Criticality: LO, jobs dropped in HI mode: %u\n", task->jobsDropped);
+             }
+         }
          fprintf(analysisFile, "  - Instances completed: %u\n", taskSet.tasks[i].instancesCompleted);
          fprintf(analysisFile, "  - Deadline misses: %u\n", taskSet.tasks[i].deadlineMisses);
          fprintf(analysisFile, "  - Average response time: %.2f ticks\n", 
@@ -168,4 +451,20 @@
      }
      
      fclose(analysisFile);
- }
\ No newline at end of file
+ }
+ 
+ void exportResults(void) {
+     uint32_t options = 0;
+     options |= runtimeMode ? RESULTS_OPTION_RUNTIME : 0;
+     options |= dvfsTableMode ? RESULTS_OPTION_DVFS_TABLE : 0;
+     options |= lowCriticalityPolicy == MC_DEGRADE_LO ? RESULTS_OPTION_MC_DEGRADE : 0;
+     options |= useVirtualDeadlines ? 0 : RESULTS_OPTION_NO_EDF_VD;
+     options |= boostOnModeSwitch ? 0 : RESULTS_OPTION_NO_MC_BOOST;
+     options |= thermalThrottling ? 0 : RESULTS_OPTION_NO_THROTTLE;
+     
+     ResultRow rows[RESULTS_MAX_ROWS];
+     int count = buildResultRows(&taskSet, &stats, options, rows);
+     if (appendResults(resultsFilename, resultsFormat, rows, count)) {
+         printf("Appended %d result rows to %s\n", count, resultsFilename);
+     }
+ }
@@ -0,0 +1,199 @@
+/**
+ * mixed_criticality.c - Dual-criticality task model with EDF-VD
+ *
+ * Every task is LO or HI criticality. HI tasks carry two WCETs: the LO-mode
+ * budget (the usual WCET column) and a larger HI-mode WCET. The system
+ * starts in LO mode. When a HI job has run for its LO budget without
+ * completing, the system switches to HI mode: LO tasks are then dropped or
+ * degraded according to the policy, and the DVFS policy may hold the
+ * highest frequency. At the next idle instant the system returns to LO mode.
+ *
+ * In LO mode HI jobs are scheduled by EDF-VD virtual deadlines, release +
+ * x * D, so that they finish their LO budget early enough to absorb an
+ * overrun. With the utilisations U_LO(LO) of the LO tasks and U_HI(LO),
+ * U_HI(HI) of the HI tasks at their two budgets, x = U_HI(LO) / (1 - U_LO(LO))
+ * and the set is EDF-VD schedulable if x * U_LO(LO) + U_HI(HI) <= 1. If
+ * U_LO(LO) + U_HI(HI) <= 1, plain EDF already suffices and x = 1.
+ *
+ * Aperiodic servers are LO criticality but are left running in HI mode;
+ * their bandwidth is already isolated by the server.
+ */
+
+ #include <stdio.h>
+ #include "mixed_criticality.h"
+ 
+ static void calculateUtilizations(const TaskSet *taskSet, double *loLo, double *hiLo, double *hiHi) {
+     *loLo = *hiLo = *hiHi = 0.0;
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         
+         // Constrained deadlines count with their density
+         TickType_t interval = task->relativeDeadline < task->period ? task->relativeDeadline : task->period;
+         if (interval == 0) {
+             continue;
+         }
+         
+         if (task->criticality == CRITICALITY_HI) {
+             *hiLo += (double)task->worstCaseExecTime / interval;
+             *hiHi += (double)task->wcetHi / interval;
+         } else {
+             *loLo += (double)task->worstCaseExecTime / interval;
+         }
+     }
+ }
+ 
+ void initializeMixedCriticality(TaskSet *taskSet, LowCriticalityPolicy policy,
+                                 bool useVirtualDeadlines, bool boostOnModeSwitch) {
+     CriticalityState *state = &taskSet->criticality;
+     
+     state->enabled = false;
+     for (int i = 0; i < taskSet->count; i++) {
+         if (taskSet->tasks[i].criticality == CRITICALITY_HI) {
+             state->enabled = true;
+         }
+     }
+     
+     state->mode = CRITICALITY_LO;
+     state->policy = policy;
+     state->useVirtualDeadlines = useVirtualDeadlines;
+     state->boostOnModeSwitch = boostOnModeSwitch;
+     state->virtualDeadlineFactor = 1.0;
+     
+     double loLo, hiLo, hiHi;
+     calculateUtilizations(taskSet, &loLo, &hiLo, &hiHi);
+     if (useVirtualDeadlines && loLo + hiHi > 1.0 && loLo < 1.0 && hiLo < 1.0 - loLo) {
+         state->virtualDeadlineFactor = hiLo / (1.0 - loLo);
+     }
+ }
+ 
+ TickType_t calculateVirtualDeadline(const TaskSet *taskSet, const Task *task, TickType_t releaseTime) {
+     if (task->criticality != CRITICALITY_HI) {
+         return releaseTime + task->relativeDeadline;
+     }
+     
+     // Rounded down so the virtual deadline never falls after the real one
+     TickType_t relative = (TickType_t)(taskSet->criticality.virtualDeadlineFactor * task->relativeDeadline);
+     return releaseTime + (relative > 0 ? relative : 1);
+ }
+ 
+ TickType_t getSchedulingDeadline(const TaskSet *taskSet, const Task *task) {
+     const CriticalityState *state = &taskSet->criticality;
+     
+     if (state->enabled && state->useVirtualDeadlines && state->mode == CRITICALITY_LO &&
+         task->criticality == CRITICALITY_HI) {
+         return task->virtualDeadline;
+     }
+     return task->absoluteDeadline;
+ }
+ 
+ bool admitRelease(const TaskSet *taskSet, const Task *task, TickType_t currentTime) {
+     const CriticalityState *state = &taskSet->criticality;
+     
+     if (!state->enabled || state->mode == CRITICALITY_LO ||
+         task->criticality == CRITICALITY_HI || isAperiodicServer(task)) {
+         return true;
+     }
+     
+     if (state->policy == MC_DROP_LO) {
+         return false;
+     }
+     
+     // Degraded: release at most once per stretched period
+     return currentTime - task->arrivalTime >= task->period * MC_DEGRADE_PERIOD_FACTOR;
+ }
+ 
+ static void enterHighCriticalityMode(TaskSet *taskSet, PowerState *powerState, TickType_t currentTime) {
+     CriticalityState *state = &taskSet->criticality;
+     
+     state->mode = CRITICALITY_HI;
+     state->modeSwitches++;
+     state->modeSwitchTime = currentTime;
+     
+     if (state->boostOnModeSwitch) {
+         powerState->isBoosted = true;
+     }
+     
+     if (state->policy != MC_DROP_LO) {
+         return;
+     }
+     
+     // Abort the active LO jobs
+     for (int i = 0; i < taskSet->count; i++) {
+         Task *task = &taskSet->tasks[i];
+         
+         if (task->criticality == CRITICALITY_HI || isAperiodicServer(task) || task->state == TASK_IDLE) {
+             continue;
+         }
+         
+         task->state = TASK_IDLE;
+         task->remainingExecutionTime = 0;
+         task->jobsDropped++;
+         task->currentInstance = (task->currentInstance + 1) % MAX_INSTANCES;
+         
+         // A deferred release is due now; admitRelease will skip it
+         if (task->releasePending) {
+             task->releasePending = false;
+             eventQueuePush(&taskSet->releaseQueue, currentTime, i);
+         }
+     }
+ }
+ 
+ // Work a HI job can still execute before it overruns its LO budget
+ TickType_t timeToBudgetOverrun(const TaskSet *taskSet, const Task *task) {
+     if (!taskSet->criticality.enabled || taskSet->criticality.mode != CRITICALITY_LO ||
+         task->criticality != CRITICALITY_HI || task->state == TASK_IDLE) {
+         return portMAX_DELAY;
+     }
+     
+     TickType_t executed = task->instanceExecutionTime - task->remainingExecutionTime;
+     TickType_t budgetLeft = executed < task->worstCaseExecTime ? task->worstCaseExecTime - executed : 0;
+     
+     // Jobs that complete within their LO budget never overrun
+     return task->remainingExecutionTime > budgetLeft ? budgetLeft : portMAX_DELAY;
+ }
+ 
+ bool checkForBudgetOverruns(TaskSet *taskSet, PowerState *powerState, TickType_t currentTime) {
+     for (int i = 0; i < taskSet->count; i++) {
+         if (timeToBudgetOverrun(taskSet, &taskSet->tasks[i]) == 0) {
+             enterHighCriticalityMode(taskSet, powerState, currentTime);
+             return true;
+         }
+     }
+     return false;
+ }
+ 
+ void checkForModeReturn(TaskSet *taskSet, PowerState *powerState, TickType_t currentTime) {
+     CriticalityState *state = &taskSet->criticality;
+     
+     // Called at an idle instant: no job carries HI-mode demand any more
+     if (state->enabled && state->mode == CRITICALITY_HI) {
+         state->mode = CRITICALITY_LO;
+         state->timeInHighMode += currentTime - state->modeSwitchTime;
+         powerState->isBoosted = false;
+     }
+ }
+ 
+ void logMixedCriticality(FILE *file, const TaskSet *taskSet, TickType_t endTime) {
+     const CriticalityState *state = &taskSet->criticality;
+     double loLo, hiLo, hiHi;
+     calculateUtilizations(taskSet, &loLo, &hiLo, &hiHi);
+     
+     double x = state->virtualDeadlineFactor;
+     bool schedulable = (loLo + hiHi <= 1.0) || (loLo < 1.0 && x <= 1.0 && x * loLo + hiHi <= 1.0);
+     
+     TickType_t timeInHighMode = state->timeInHighMode;
+     if (state->mode == CRITICALITY_HI && endTime > state->modeSwitchTime) {
+         timeInHighMode += endTime - state->modeSwitchTime;
+     }
+     
+     fprintf(file, "Mixed criticality (%s, %s LO tasks in HI mode%s):\n",
+             state->useVirtualDeadlines ? "EDF-VD" : "EDF",
+             state->policy == MC_DROP_LO ? "drop" : "degrade",
+             state->boostOnModeSwitch ? ", boost" : "");
+     fprintf(file, "  - Utilization: U_LO(LO) %.3f, U_HI(LO) %.3f, U_HI(HI) %.3f\n", loLo, hiLo, hiHi);
+     fprintf(file, "  - Virtual deadline factor: %.3f (schedulability test %s)\n", x, schedulable ? "passed" : "failed");
+     fprintf(file, "  - Mode switches: %u\n", state->modeSwitches);
+     fprintf(file, "  - Time in HI mode: %u ticks (%.2f%%)\n", (unsigned int)timeInHighMode,
+             endTime > 0 ? (float)timeInHighMode / endTime * 100 : 0);
+ }
@@ -0,0 +1,24 @@
+/**
+ * mixed_criticality.h - Dual-criticality task model with EDF-VD
+ */
+
+ #ifndef MIXED_CRITICALITY_H
+ #define MIXED_CRITICALITY_H
+ 
+ #include <stdio.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "task_set.h"
+ 
+ // Function prototypes
+ void initializeMixedCriticality(TaskSet *taskSet, LowCriticalityPolicy policy,
+                                 bool useVirtualDeadlines, bool boostOnModeSwitch);
+ TickType_t calculateVirtualDeadline(const TaskSet *taskSet, const Task *task, TickType_t releaseTime);
+ TickType_t getSchedulingDeadline(const TaskSet *taskSet, const Task *task);
+ bool admitRelease(const TaskSet *taskSet, const Task *task, TickType_t currentTime);
+ bool checkForBudgetOverruns(TaskSet *taskSet, PowerState *powerState, TickType_t currentTime);
+ void checkForModeReturn(TaskSet *taskSet, PowerState *powerState, TickType_t currentTime);
+ TickType_t timeToBudgetOverrun(const TaskSet *taskSet, const Task *task);
+ void logMixedCriticality(FILE *file, const TaskSet *taskSet, TickType_t endTime);
+ 
+ #endif /* MIXED_CRITICALITY_H */
@@ -0,0 +1,436 @@
+/**
+ * offline_solver.c - Offline minimum-energy frequency assignment
+ *
+ * Computes the minimum-energy feasible schedule for every job released in
+ * the simulated horizon, given the actual execution times. This is the
+ * lower bound the online DVFS heuristic is measured against.
+ *
+ * Continuous speeds come from the Yao-Demers-Shenker (YDS) algorithm: the
+ * interval [a, b] of maximum intensity (work of the jobs contained in it
+ * divided by its length) is critical, its jobs run at exactly that speed,
+ * and the interval is cut out of the timeline before the next round. Each
+ * round finds the critical interval by Dinkelbach iteration: for a guess
+ * g, maximise W(a, b) - g * (b - a) with one sweep over the deadlines and
+ * a segment tree over the release times (O(n log n)), then move g to the
+ * intensity of the interval found. This converges in a few steps, giving
+ * O(n^2 log n) overall for n jobs.
+ *
+ * The continuous speed s of each job is then realised with the two
+ * neighbouring discrete levels f_lo < s <= f_hi, splitting the job's time
+ * between them so the work and duration are unchanged. This is optimal
+ * for a convex power function.
+ *
+ * Only the horizon is charged. A job whose deadline lies past it keeps the
+ * part of its work that could not run after the horizon even at the
+ * highest level, with its deadline moved to the horizon, so the busy time
+ * of a feasible solution never exceeds the horizon.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <math.h>
+ #include "offline_solver.h"
+ 
+ #define SOLVER_EPSILON 1e-9
+ #define MAX_DINKELBACH_STEPS 64
+ 
+ // A job in (compressed) time
+ typedef struct {
+     double release;
+     double deadline;
+     double work;
+     double speed;
+     bool scheduled;
+ } SolverJob;
+ 
+ // Max segment tree with range add, over the candidate interval starts
+ typedef struct {
+     double *max;
+     double *pending;
+     int *argmax;
+     int size;
+ } SegmentTree;
+ 
+ static void treeBuild(SegmentTree *tree, int node, int low, int high, const double *values) {
+     tree->pending[node] = 0.0;
+     if (low == high) {
+         tree->max[node] = values[low];
+         tree->argmax[node] = low;
+         return;
+     }
+     
+     int mid = (low + high) / 2;
+     treeBuild(tree, 2 * node, low, mid, values);
+     treeBuild(tree, 2 * node + 1, mid + 1, high, values);
+     
+     bool leftWins = tree->max[2 * node] >= tree->max[2 * node + 1];
+     tree->max[node] = leftWins ? tree->max[2 * node] : tree->max[2 * node + 1];
+     tree->argmax[node] = leftWins ? tree->argmax[2 * node] : tree->argmax[2 * node + 1];
+ }
+ 
+ static void treeAdd(SegmentTree *tree, int node, int low, int high, int from, int to, double value) {
+     if (to < low || high < from) {
+         return;
+     }
+     if (from <= low && high <= to) {
+         tree->max[node] += value;
+         tree->pending[node] += value;
+         return;
+     }
+     
+     int mid = (low + high) / 2;
+     treeAdd(tree, 2 * node, low, mid, from, to, value);
+     treeAdd(tree, 2 * node + 1, mid + 1, high, from, to, value);
+     
+     bool leftWins = tree->max[2 * node] >= tree->max[2 * node + 1];
+     tree->max[node] = tree->pending[node] + (leftWins ? tree->max[2 * node] : tree->max[2 * node + 1]);
+     tree->argmax[node] = leftWins ? tree->argmax[2 * node] : tree->argmax[2 * node + 1];
+ }
+ 
+ static void treeQuery(const SegmentTree *tree, int node, int low, int high, int from, int to,
+                       double offset, double *bestValue, int *bestIndex) {
+     if (to < low || high < from) {
+         return;
+     }
+     if (from <= low && high <= to) {
+         if (tree->max[node] + offset > *bestValue) {
+             *bestValue = tree->max[node] + offset;
+             *bestIndex = tree->argmax[node];
+         }
+         return;
+     }
+     
+     int mid = (low + high) / 2;
+     offset += tree->pending[node];
+     treeQuery(tree, 2 * node, low, mid, from, to, offset, bestValue, bestIndex);
+     treeQuery(tree, 2 * node + 1, mid + 1, high, from, to, offset, bestValue, bestIndex);
+ }
+ 
+ static int compareDoubles(const void *a, const void *b) {
+     double left = *(const double *)a;
+     double right = *(const double *)b;
+     return (left > right) - (left < right);
+ }
+ 
+ static int compareJobsByDeadline(const void *a, const void *b) {
+     const SolverJob *left = a;
+     const SolverJob *right = b;
+     return (left->deadline > right->deadline) - (left->deadline < right->deadline);
+ }
+ 
+ // Index of the last start <= value (starts are sorted), or -1
+ static int lastStartAtOrBefore(const double *starts, int count, double value) {
+     int low = 0, high = count - 1, found = -1;
+     while (low <= high) {
+         int mid = (low + high) / 2;
+         if (starts[mid] <= value + SOLVER_EPSILON) {
+             found = mid;
+             low = mid + 1;
+         } else {
+             high = mid - 1;
+         }
+     }
+     return found;
+ }
+ 
+ // Maximise W(a, b) - g * (b - a) over intervals whose ends are a release
+ // and a deadline. Jobs must be sorted by deadline. Returns the maximum.
+ static double findBestInterval(const SolverJob *jobs, int jobCount, const double *starts, int startCount,
+                                double *values, SegmentTree *tree, double intensity,
+                                double *bestStart, double *bestEnd, double *bestWork) {
+     // Each start a begins with value g * a; adding a job adds its work to
+     // every start at or before its release
+     for (int i = 0; i < startCount; i++) {
+         values[i] = intensity * starts[i];
+     }
+     treeBuild(tree, 1, 0, startCount - 1, values);
+     
+     double best = -INFINITY;
+     int i = 0;
+     while (i < jobCount) {
+         double end = jobs[i].deadline;
+         
+         // Add every job with this deadline
+         while (i < jobCount && jobs[i].deadline <= end + SOLVER_EPSILON) {
+             if (!jobs[i].scheduled) {
+                 int last = lastStartAtOrBefore(starts, startCount, jobs[i].release);
+                 if (last >= 0) {
+                     treeAdd(tree, 1, 0, startCount - 1, 0, last, jobs[i].work);
+                 }
+             }
+             i++;
+         }
+         
+         // Best start strictly before this deadline
+         int lastStart = lastStartAtOrBefore(starts, startCount, end - 2 * SOLVER_EPSILON);
+         if (lastStart < 0) {
+             continue;
+         }
+         
+         double value = -INFINITY;
+         int index = -1;
+         treeQuery(tree, 1, 0, startCount - 1, 0, lastStart, 0.0, &value, &index);
+         
+         value -= intensity * end;
+         if (index >= 0 && value > best) {
+             best = value;
+             *bestStart = starts[index];
+             *bestEnd = end;
+             *bestWork = value + intensity * (end - starts[index]);
+         }
+     }
+     
+     return best;
+ }
+ 
+ // Energy and time to run one job at continuous speed s on the discrete levels
+ static void splitAcrossLevels(SolverJob *job, OfflineSolution *solution) {
+     double lowest = getFrequencyLevel(0);
+     double highest = getFrequencyLevel(DVFS_LEVELS - 1);
+     
+     if (job->speed <= lowest + SOLVER_EPSILON) {
+         double time = job->work / lowest;
+         solution->timeAtFrequency[0] += time;
+         solution->busyEnergy += time * calculateActiveEnergy((float)lowest);
+         return;
+     }
+     
+     if (job->speed >= highest - SOLVER_EPSILON) {
+         double time = job->work / highest;
+         solution->timeAtFrequency[DVFS_LEVELS - 1] += time;
+         solution->busyEnergy += time * calculateActiveEnergy((float)highest);
+         return;
+     }
+     
+     int upper = 1;
+     while (upper < DVFS_LEVELS - 1 && getFrequencyLevel(upper) < job->speed) {
+         upper++;
+     }
+     
+     double fLow = getFrequencyLevel(upper - 1);
+     double fHigh = getFrequencyLevel(upper);
+     double duration = job->work / job->speed;
+     double timeHigh = (job->work - fLow * duration) / (fHigh - fLow);
+     double timeLow = duration - timeHigh;
+     
+     solution->timeAtFrequency[upper] += timeHigh;
+     solution->timeAtFrequency[upper - 1] += timeLow;
+     solution->busyEnergy += timeHigh * calculateActiveEnergy((float)fHigh) +
+                             timeLow * calculateActiveEnergy((float)fLow);
+ }
+ 
+ // Add a job released before the horizon, keeping only the work that has to
+ // run before it
+ static void addJob(SolverJob *jobs, int *count, TickType_t release, TickType_t deadline,
+                    TickType_t work, TickType_t horizon) {
+     double due = work;
+     double end = deadline;
+     
+     if (deadline > horizon) {
+         due -= (double)(deadline - horizon) * getFrequencyLevel(DVFS_LEVELS - 1);
+         end = horizon;
+     }
+     if (due <= SOLVER_EPSILON) {
+         return;
+     }
+     
+     jobs[*count].release = release;
+     jobs[*count].deadline = end;
+     jobs[*count].work = due;
+     jobs[*count].scheduled = false;
+     (*count)++;
+ }
+ 
+ // Collect the jobs released in [0, horizon)
+ static SolverJob *buildJobs(const TaskSet *taskSet, TickType_t horizon, int *jobCount) {
+     int capacity = 0;
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         if (task->kind == TASK_PERIODIC && task->period > 0) {
+             capacity += (int)(horizon / task->period) + 1;
+         } else if (task->kind == TASK_SPORADIC) {
+             capacity += (int)task->arrivalCount;
+         }
+     }
+     
+     SolverJob *jobs = malloc(sizeof(SolverJob) * (capacity > 0 ? capacity : 1));
+     if (jobs == NULL) {
+         return NULL;
+     }
+     
+     int count = 0;
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         
+         if (task->kind == TASK_PERIODIC && task->period > 0) {
+             int instance = 0;
+             for (TickType_t release = 0; release < horizon; release += task->period) {
+                 TickType_t work = task->actualExecutionTime[instance % MAX_INSTANCES];
+                 if (work > 0 && task->relativeDeadline > 0) {
+                     addJob(jobs, &count, release, release + task->relativeDeadline, work, horizon);
+                 }
+                 instance++;
+             }
+         } else if (task->kind == TASK_SPORADIC) {
+             // Releases with the minimum inter-arrival time enforced, as online
+             TickType_t earliest = 0;
+             for (unsigned int j = 0; j < task->arrivalCount; j++) {
+                 TickType_t release = task->arrivals[j].releaseTime > earliest ?
+                                      task->arrivals[j].releaseTime : earliest;
+                 if (release >= horizon) {
+                     break;
+                 }
+                 if (task->arrivals[j].executionTime > 0 && task->relativeDeadline > 0) {
+                     addJob(jobs, &count, release, release + task->relativeDeadline,
+                            task->arrivals[j].executionTime, horizon);
+                 }
+                 earliest = release + task->period;
+             }
+         }
+     }
+     
+     *jobCount = count;
+     return jobs;
+ }
+ 
+ bool solveOptimalFrequencyAssignment(const TaskSet *taskSet, TickType_t horizon, OfflineSolution *solution) {
+     memset(solution, 0, sizeof(OfflineSolution));
+     solution->feasible = true;
+     
+     int jobCount = 0;
+     SolverJob *jobs = buildJobs(taskSet, horizon, &jobCount);
+     if (jobs == NULL) {
+         printf("Error allocating memory for the offline solver.\n");
+         return false;
+     }
+     solution->jobCount = (unsigned int)jobCount;
+     
+     double *starts = malloc(sizeof(double) * (jobCount > 0 ? jobCount : 1));
+     double *values = malloc(sizeof(double) * (jobCount > 0 ? jobCount : 1));
+     SegmentTree tree;
+     tree.size = 4 * (jobCount > 0 ? jobCount : 1);
+     tree.max = malloc(sizeof(double) * tree.size);
+     tree.pending = malloc(sizeof(double) * tree.size);
+     tree.argmax = malloc(sizeof(int) * tree.size);
+     
+     if (starts == NULL || values == NULL || tree.max == NULL || tree.pending == NULL || tree.argmax == NULL) {
+         printf("Error allocating memory for the offline solver.\n");
+         free(jobs); free(starts); free(values);
+         free(tree.max); free(tree.pending); free(tree.argmax);
+         return false;
+     }
+     
+     // Compression keeps the deadline order, so one sort serves every round
+     qsort(jobs, jobCount, sizeof(SolverJob), compareJobsByDeadline);
+     int remaining = jobCount;
+     
+     while (remaining > 0) {
+         // Candidate starts: distinct releases of the unscheduled jobs
+         int startCount = 0;
+         double totalWork = 0.0, spanStart = INFINITY, spanEnd = -INFINITY;
+         for (int i = 0; i < jobCount; i++) {
+             if (jobs[i].scheduled) {
+                 continue;
+             }
+             starts[startCount++] = jobs[i].release;
+             totalWork += jobs[i].work;
+             spanStart = fmin(spanStart, jobs[i].release);
+             spanEnd = fmax(spanEnd, jobs[i].deadline);
+         }
+         qsort(starts, startCount, sizeof(double), compareDoubles);
+         int distinct = 0;
+         for (int i = 0; i < startCount; i++) {
+             if (distinct == 0 || starts[i] > starts[distinct - 1] + SOLVER_EPSILON) {
+                 starts[distinct++] = starts[i];
+             }
+         }
+         startCount = distinct;
+         
+         // Dinkelbach iteration from the intensity of the whole span
+         double intensity = totalWork / fmax(spanEnd - spanStart, SOLVER_EPSILON);
+         double criticalStart = spanStart, criticalEnd = spanEnd;
+         for (int step = 0; step < MAX_DINKELBACH_STEPS; step++) {
+             double start, end, work;
+             double excess = findBestInterval(jobs, jobCount, starts, startCount, values, &tree,
+                                              intensity, &start, &end, &work);
+             if (excess <= SOLVER_EPSILON * (1.0 + totalWork)) {
+                 break;
+             }
+             intensity = work / (end - start);
+             criticalStart = start;
+             criticalEnd = end;
+         }
+         
+         // Jobs inside the critical interval run at its intensity
+         for (int i = 0; i < jobCount; i++) {
+             if (!jobs[i].scheduled && jobs[i].release >= criticalStart - SOLVER_EPSILON &&
+                 jobs[i].deadline <= criticalEnd + SOLVER_EPSILON) {
+                 jobs[i].speed = intensity;
+                 jobs[i].scheduled = true;
+                 remaining--;
+             }
+         }
+         solution->criticalIntervals++;
+         if (intensity > solution->peakSpeed) {
+             solution->peakSpeed = intensity;
+         }
+         
+         // Cut the critical interval out of the timeline. Scheduled jobs are
+         // mapped too so the array stays sorted by deadline.
+         double length = criticalEnd - criticalStart;
+         for (int i = 0; i < jobCount; i++) {
+             double *times[2] = { &jobs[i].release, &jobs[i].deadline };
+             for (int t = 0; t < 2; t++) {
+                 if (*times[t] >= criticalEnd) {
+                     *times[t] -= length;
+                 } else if (*times[t] > criticalStart) {
+                     *times[t] = criticalStart;
+                 }
+             }
+         }
+     }
+     
+     // Realise the continuous speeds on the discrete levels
+     double busyTime = 0.0;
+     for (int i = 0; i < jobCount; i++) {
+         splitAcrossLevels(&jobs[i], solution);
+     }
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         busyTime += solution->timeAtFrequency[i];
+     }
+     
+     solution->feasible = solution->peakSpeed <= getFrequencyLevel(DVFS_LEVELS - 1) + SOLVER_EPSILON;
+     solution->idleEnergy = fmax((double)horizon - busyTime, 0.0) * DPM_LEAKAGE_ENERGY;
+     solution->energy = solution->busyEnergy + solution->idleEnergy;
+     
+     free(jobs);
+     free(starts);
+     free(values);
+     free(tree.max);
+     free(tree.pending);
+     free(tree.argmax);
+     return true;
+ }
+ 
+ void logOfflineSolution(FILE *file, const OfflineSolution *solution, double onlineEnergy) {
+     fprintf(file, "Offline optimum (YDS + discrete split):\n");
+     fprintf(file, "  - Jobs: %u in %u critical intervals\n", solution->jobCount, solution->criticalIntervals);
+     fprintf(file, "  - Peak continuous speed: %.3f\n", solution->peakSpeed);
+     
+     if (!solution->feasible) {
+         fprintf(file, "  - Infeasible: peak speed exceeds the highest frequency level\n");
+     }
+     
+     fprintf(file, "  - Minimum energy: %.2f units (busy %.2f, idle %.2f)\n",
+             solution->energy, solution->busyEnergy, solution->idleEnergy);
+     
+     // No ratio: the simulation retires a whole unit of work per tick at any
+     // level, so its energy is not bounded by this figure
+     fprintf(file, "  - Online energy, for comparison: %.2f units\n", onlineEnergy);
+     
+     for (int i = DVFS_LEVELS - 1; i >= 0; i--) {
+         fprintf(file, "  - Time at %.1f: %.2f ticks\n", getFrequencyLevel(i), solution->timeAtFrequency[i]);
+     }
+ }
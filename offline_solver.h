@@ -0,0 +1,29 @@
+/**
+ * offline_solver.h - Offline minimum-energy frequency assignment
+ */
+
+ #ifndef OFFLINE_SOLVER_H
+ #define OFFLINE_SOLVER_H
+ 
+ #include <stdio.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "task_set.h"
+ 
+ // Result of the offline solver
+ typedef struct {
+     bool feasible;                     // All jobs fit at the highest frequency level
+     unsigned int jobCount;             // Jobs released within the horizon
+     unsigned int criticalIntervals;    // YDS rounds
+     double peakSpeed;                  // Highest continuous (YDS) speed
+     double busyEnergy;                 // Energy of executing all jobs
+     double idleEnergy;                 // Leakage energy of the remaining time
+     double energy;                     // busyEnergy + idleEnergy
+     double timeAtFrequency[DVFS_LEVELS]; // Ticks spent at each level
+ } OfflineSolution;
+ 
+ // Function prototypes
+ bool solveOptimalFrequencyAssignment(const TaskSet *taskSet, TickType_t horizon, OfflineSolution *solution);
+ void logOfflineSolution(FILE *file, const OfflineSolution *solution, double onlineEnergy);
+ 
+ #endif /* OFFLINE_SOLVER_H */
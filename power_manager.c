@@ -5,6 +5,7 @@
  #include <stdio.h>
  #include "power_manager.h"
  #include "task_set.h"
+ #include "dvfs_table.h"
  
  // Available frequency levels
  static const float availableFrequencyLevels[DVFS_LEVELS] = {0.4, 0.6, 0.8, 1.0};
@@ -28,36 +29,26 @@
      
      // CCEDF algorithm:
      // 1. Calculate required frequency based on utilization and slack
-     float requiredFrequency = 0.0;
+     // 2. Find the minimum frequency level that meets the requirement
+     int selectedFrequencyIndex = 0;  // Default to lowest frequency
      
-     if (task != NULL) {
-         // Calculate minimum required frequency to meet the deadline
-         TickType_t timeToDeadline = task->absoluteDeadline - task->arrivalTime;
-         requiredFrequency = (float)task->actualExecutionTime[task->currentInstance] / timeToDeadline;
+     if (currentState->isBoosted) {
+         // HI mode: run HI jobs as fast as possible until the next idle instant
+         selectedFrequencyIndex = DVFS_LEVELS - 1;
+     } else if (task != NULL) {
+         TickType_t work, timeToDeadline;
+         getDVFSDecisionKey(task, &work, &timeToDeadline);
          
-         // Adjust for remaining work
-         if (task->remainingExecutionTime > 0) {
-             TickType_t currentTimeToDeadline = task->absoluteDeadline - 
-                                               (task->arrivalTime + task->actualExecutionTime[task->currentInstance] - 
-                                                task->remainingExecutionTime);
-             
-             if (currentTimeToDeadline > 0) {
-                 requiredFrequency = (float)task->remainingExecutionTime / currentTimeToDeadline;
-             } else {
-                 // Past deadline, use maximum frequency
-                 requiredFrequency = 1.0;
-             }
+         // Constant-time lookup when decision tables are enabled
+         selectedFrequencyIndex = lookupFrequencyIndex(task, work, timeToDeadline);
+         if (selectedFrequencyIndex < 0) {
+             selectedFrequencyIndex = selectFrequencyIndex(calculateRequiredFrequency(work, timeToDeadline));
          }
      }
      
-     // Find the minimum frequency level that meets the requirement
-     int selectedFrequencyIndex = 0;  // Default to lowest frequency
-     
-     for (int i = 0; i < DVFS_LEVELS; i++) {
-         if (availableFrequencyLevels[i] >= requiredFrequency) {
-             selectedFrequencyIndex = i;
-             break;
-         }
+     // Thermal throttling overrides every other policy
+     if (selectedFrequencyIndex > currentState->frequencyCap) {
+         selectedFrequencyIndex = currentState->frequencyCap;
      }
      
      float newFrequency = availableFrequencyLevels[selectedFrequencyIndex];
@@ -71,6 +62,41 @@
      return decision;
  }
  
+ void getDVFSDecisionKey(const Task *task, TickType_t *work, TickType_t *timeToDeadline) {
+     // Minimum required frequency to meet the deadline
+     *work = task->instanceExecutionTime;
+     *timeToDeadline = task->absoluteDeadline - task->arrivalTime;
+     
+     // Adjust for remaining work
+     if (task->remainingExecutionTime > 0) {
+         *work = task->remainingExecutionTime;
+         *timeToDeadline = task->absoluteDeadline - 
+                           (task->arrivalTime + task->instanceExecutionTime - 
+                            task->remainingExecutionTime);
+     }
+ }
+ 
+ float calculateRequiredFrequency(TickType_t work, TickType_t timeToDeadline) {
+     if (timeToDeadline > 0) {
+         return (float)work / timeToDeadline;
+     }
+     // Past deadline, use maximum frequency
+     return 1.0;
+ }
+ 
+ int selectFrequencyIndex(float requiredFrequency) {
+     int selectedFrequencyIndex = 0;  // Default to lowest frequency
+     
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         if (availableFrequencyLevels[i] >= requiredFrequency) {
+             selectedFrequencyIndex = i;
+             break;
+         }
+     }
+     
+     return selectedFrequencyIndex;
+ }
+ 
  PowerDecision makeDPMDecision(TickType_t slack, PowerState *currentState) {
      PowerDecision decision;
      decision.type = POWER_NO_CHANGE;
@@ -106,4 +132,22 @@
              // No change
              break;
      }
+ }
+ 
+ float getFrequencyLevel(int index) {
+     return availableFrequencyLevels[index];
+ }
+ 
+ float calculateActiveEnergy(float frequencyLevel) {
+     // Energy ∝ Voltage² × Frequency
+     float voltage = frequencyLevel;  // Assuming voltage scales with frequency
+     return voltage * voltage * frequencyLevel;
+ }
+ 
+ float calculateTickEnergy(const PowerState *state) {
+     // If DPM is active, use static leakage energy only (much lower)
+     if (state->isDPMActive) {
+         return DPM_LEAKAGE_ENERGY;
+     }
+     return calculateActiveEnergy(state->frequencyLevel);
  }
\ No newline at end of file
@@ -15,6 +15,8 @@
  typedef struct {
      float frequencyLevel;  // Current frequency level (0.4, 0.6, 0.8, or 1.0)
      bool isDPMActive;      // Whether system is in power-down mode
+     bool isBoosted;        // Held at the highest level after a criticality mode switch
+     int frequencyCap;      // Highest level index allowed; lowered by thermal throttling
  } PowerState;
  
  // Power decision types
@@ -34,11 +36,18 @@
  // Constants
  #define DVFS_LEVELS 4
  #define DPM_THRESHOLD 20  // Minimum slack for DPM activation
+ #define DPM_LEAKAGE_ENERGY 0.05f  // Static leakage energy per tick in power-down mode
  
  // Function prototypes
  void initializePowerManager(void);
  PowerDecision makeDVFSDecision(Task *task, TickType_t slack, PowerState *currentState);
  PowerDecision makeDPMDecision(TickType_t slack, PowerState *currentState);
  void applyPowerDecision(PowerDecision *decision, PowerState *state);
+ void getDVFSDecisionKey(const Task *task, TickType_t *work, TickType_t *timeToDeadline);
+ float calculateRequiredFrequency(TickType_t work, TickType_t timeToDeadline);
+ int selectFrequencyIndex(float requiredFrequency);
+ float getFrequencyLevel(int index);
+ float calculateActiveEnergy(float frequencyLevel);
+ float calculateTickEnergy(const PowerState *state);
  
  #endif /* POWER_MANAGER_H */
\ No newline at end of file
@@ -0,0 +1,301 @@
+/**
+ * results.c - Typed per-run result rows in append-only result files
+ *
+ * Every run appends one row for the run as a whole and one row per task to
+ * a results file, so sweeps can be aggregated without parsing analysis.txt
+ * (see results_summary.c). The file is either CSV or a binary columnar
+ * format holding a schema header followed by one column-major block per run.
+ *
+ * Many sweep workers may append to the same file at once. Each run's rows
+ * are encoded into one buffer and written with a single write() on an
+ * O_APPEND descriptor: the kernel positions and writes it as one unit, so
+ * rows of different runs never interleave and no lock is taken. A new file
+ * is created with its header under a temporary name and linked into place,
+ * so no writer can append to a file that has no header yet.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <stddef.h>
+ #include <errno.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+ #include <sys/stat.h>
+ #include "results.h"
+ #include "checkpoint.h"
+ 
+ #define CSV_ROW_LENGTH 512  // Upper bound on one formatted CSV row
+ 
+ // Column of the result schema
+ typedef struct {
+     const char *name;
+     ResultsColumnType type;
+     size_t offset;          // Offset of the value in ResultRow
+ } ResultsColumn;
+ 
+ #define FREQUENCY_COLUMN(index) (offsetof(ResultRow, ticksAtFrequency) + (index) * sizeof(uint32_t))
+ 
+ // The frequency columns follow the level table in power_manager.c, highest first
+ static const ResultsColumn columns[] = {
+     {"config_hash",          RESULTS_HEX32, offsetof(ResultRow, configHash)},
+     {"input_hash",           RESULTS_HEX32, offsetof(ResultRow, inputHash)},
+     {"options",              RESULTS_HEX32, offsetof(ResultRow, options)},
+     {"task",                 RESULTS_I32,   offsetof(ResultRow, task)},
+     {"ticks",                RESULTS_U32,   offsetof(ResultRow, ticks)},
+     {"energy",               RESULTS_F64,   offsetof(ResultRow, energy)},
+     {"ticks_at_1.0",         RESULTS_U32,   FREQUENCY_COLUMN(3)},
+     {"ticks_at_0.8",         RESULTS_U32,   FREQUENCY_COLUMN(2)},
+     {"ticks_at_0.6",         RESULTS_U32,   FREQUENCY_COLUMN(1)},
+     {"ticks_at_0.4",         RESULTS_U32,   FREQUENCY_COLUMN(0)},
+     {"ticks_power_down",     RESULTS_U32,   offsetof(ResultRow, ticksPowerDown)},
+     {"power_down_residency", RESULTS_F64,   offsetof(ResultRow, powerDownResidency)},
+     {"completed",            RESULTS_U32,   offsetof(ResultRow, completed)},
+     {"misses",               RESULTS_U32,   offsetof(ResultRow, misses)},
+     {"response_mean",        RESULTS_F64,   offsetof(ResultRow, responseMean)},
+     {"response_p50",         RESULTS_U32,   offsetof(ResultRow, responseP50)},
+     {"response_p95",         RESULTS_U32,   offsetof(ResultRow, responseP95)},
+     {"response_p99",         RESULTS_U32,   offsetof(ResultRow, responseP99)},
+     {"response_max",         RESULTS_U32,   offsetof(ResultRow, responseMax)}
+ };
+ 
+ #define COLUMN_COUNT ((int)(sizeof(columns) / sizeof(columns[0])))
+ 
+ static void setResponseColumns(ResultRow *row, const Histogram *histogram, double totalResponseTime) {
+     row->responseMean = histogram->total > 0 ? totalResponseTime / histogram->total : 0.0;
+     row->responseP50 = histogramPercentile(histogram, 50.0);
+     row->responseP95 = histogramPercentile(histogram, 95.0);
+     row->responseP99 = histogramPercentile(histogram, 99.0);
+     row->responseMax = histogram->max;
+ }
+ 
+ int buildResultRows(const TaskSet *taskSet, const SchedulerStats *stats, uint32_t options, ResultRow *rows) {
+     ResultRow run;
+     memset(&run, 0, sizeof(ResultRow));
+     
+     run.configHash = fingerprintTaskParameters(fingerprintU32(FINGERPRINT_SEED, options), taskSet);
+     run.inputHash = taskSet->fingerprint;
+     run.options = options;
+     run.task = RESULTS_RUN_ROW;
+     run.ticks = stats->totalExecutionTime;
+     run.energy = stats->energyConsumption;
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         run.ticksAtFrequency[i] = stats->timeAtFrequency[i];
+     }
+     run.ticksPowerDown = stats->timeInPowerDown;
+     run.powerDownResidency = run.ticks > 0 ? (double)run.ticksPowerDown / run.ticks : 0.0;
+     
+     // Task rows, with the run row's response times merged from them
+     Histogram allResponseTimes;
+     double allResponseTime = 0.0;
+     memset(&allResponseTimes, 0, sizeof(Histogram));
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         ResultRow *row = &rows[i + 1];
+         
+         *row = run;
+         row->task = task->id;
+         row->completed = task->instancesCompleted;
+         row->misses = task->deadlineMisses;
+         setResponseColumns(row, &taskSet->responseTimes[i], task->totalResponseTime);
+         
+         run.completed += task->instancesCompleted;
+         run.misses += task->deadlineMisses;
+         histogramMerge(&allResponseTimes, &taskSet->responseTimes[i]);
+         allResponseTime += task->totalResponseTime;
+     }
+     
+     setResponseColumns(&run, &allResponseTimes, allResponseTime);
+     rows[0] = run;
+     return taskSet->count + 1;
+ }
+ 
+ // Little-endian encoding helpers
+ static unsigned char *putU32(unsigned char *out, uint32_t value) {
+     out[0] = (unsigned char)(value);
+     out[1] = (unsigned char)(value >> 8);
+     out[2] = (unsigned char)(value >> 16);
+     out[3] = (unsigned char)(value >> 24);
+     return out + 4;
+ }
+ 
+ static unsigned char *putF64(unsigned char *out, double value) {
+     uint64_t bits;
+     memcpy(&bits, &value, sizeof(bits));
+     out = putU32(out, (uint32_t)bits);
+     return putU32(out, (uint32_t)(bits >> 32));
+ }
+ 
+ static uint32_t columnU32(const ResultRow *row, const ResultsColumn *column) {
+     uint32_t value;
+     memcpy(&value, (const char *)row + column->offset, sizeof(value));
+     return value;
+ }
+ 
+ static double columnF64(const ResultRow *row, const ResultsColumn *column) {
+     double value;
+     memcpy(&value, (const char *)row + column->offset, sizeof(value));
+     return value;
+ }
+ 
+ // File header of the given format; returns its size
+ static size_t encodeHeader(ResultsFormat format, unsigned char *out, size_t capacity) {
+     if (format == RESULTS_FORMAT_CSV) {
+         size_t length = 0;
+         for (int c = 0; c < COLUMN_COUNT; c++) {
+             length += snprintf((char *)out + length, capacity - length, "%s%s",
+                                c > 0 ? "," : "", columns[c].name);
+         }
+         length += snprintf((char *)out + length, capacity - length, "\n");
+         return length;
+     }
+     
+     unsigned char *cursor = putU32(out, RESULTS_FILE_MAGIC);
+     cursor = putU32(cursor, RESULTS_FORMAT_VERSION);
+     cursor = putU32(cursor, COLUMN_COUNT);
+     for (int c = 0; c < COLUMN_COUNT; c++) {
+         cursor = putU32(cursor, (uint32_t)columns[c].type);
+         memset(cursor, 0, RESULTS_NAME_LENGTH);
+         strncpy((char *)cursor, columns[c].name, RESULTS_NAME_LENGTH - 1);
+         cursor += RESULTS_NAME_LENGTH;
+     }
+     return (size_t)(cursor - out);
+ }
+ 
+ // All rows of one run as a single buffer; returns its size
+ static size_t encodeBatch(ResultsFormat format, const ResultRow *rows, int count, unsigned char *out) {
+     if (format == RESULTS_FORMAT_CSV) {
+         size_t length = 0;
+         for (int r = 0; r < count; r++) {
+             for (int c = 0; c < COLUMN_COUNT; c++) {
+                 const ResultsColumn *column = &columns[c];
+                 char *cursor = (char *)out + length;
+                 const char *separator = c > 0 ? "," : "";
+                 
+                 switch (column->type) {
+                     case RESULTS_HEX32:
+                         length += sprintf(cursor, "%s0x%08x", separator, (unsigned int)columnU32(&rows[r], column));
+                         break;
+                     case RESULTS_I32:
+                         length += sprintf(cursor, "%s%d", separator, (int)(int32_t)columnU32(&rows[r], column));
+                         break;
+                     case RESULTS_F64:
+                         length += sprintf(cursor, "%s%.6f", separator, columnF64(&rows[r], column));
+                         break;
+                     case RESULTS_U32:
+                     default:
+                         length += sprintf(cursor, "%s%u", separator, (unsigned int)columnU32(&rows[r], column));
+                         break;
+                 }
+             }
+             out[length++] = '\n';
+         }
+         return length;
+     }
+     
+     // Column-major: all values of a column are contiguous
+     unsigned char *cursor = putU32(out, RESULTS_BLOCK_MAGIC);
+     cursor = putU32(cursor, (uint32_t)count);
+     for (int c = 0; c < COLUMN_COUNT; c++) {
+         for (int r = 0; r < count; r++) {
+             if (columns[c].type == RESULTS_F64) {
+                 cursor = putF64(cursor, columnF64(&rows[r], &columns[c]));
+             } else {
+                 cursor = putU32(cursor, columnU32(&rows[r], &columns[c]));
+             }
+         }
+     }
+     return (size_t)(cursor - out);
+ }
+ 
+ static bool writeAll(int fd, const unsigned char *data, size_t size) {
+     while (size > 0) {
+         ssize_t written = write(fd, data, size);
+         if (written <= 0) {
+             return false;
+         }
+         data += written;
+         size -= (size_t)written;
+     }
+     return true;
+ }
+ 
+ // Make sure the file exists and starts with the expected header
+ static bool prepareResultsFile(const char *filename, const unsigned char *header, size_t headerSize) {
+     int fd = open(filename, O_RDONLY);
+     
+     if (fd < 0 && errno == ENOENT) {
+         char tempFilename[512];
+         snprintf(tempFilename, sizeof(tempFilename), "%s.XXXXXX", filename);
+         int tempFd = mkstemp(tempFilename);
+         if (tempFd < 0) {
+             printf("Error creating results file: %s\n", filename);
+             return false;
+         }
+         
+         bool written = fchmod(tempFd, 0644) == 0 && writeAll(tempFd, header, headerSize);
+         written = (close(tempFd) == 0) && written;
+         
+         // Another worker may have created the file first; its header is checked below
+         if (!written || (link(tempFilename, filename) != 0 && errno != EEXIST)) {
+             printf("Error creating results file: %s\n", filename);
+             unlink(tempFilename);
+             return false;
+         }
+         unlink(tempFilename);
+         fd = open(filename, O_RDONLY);
+     }
+     
+     if (fd < 0) {
+         printf("Error opening results file: %s\n", filename);
+         return false;
+     }
+     
+     // Appending rows of another format or schema would make the file unreadable
+     unsigned char existing[1024];
+     ssize_t length = read(fd, existing, headerSize);
+     close(fd);
+     
+     if (length != (ssize_t)headerSize || memcmp(existing, header, headerSize) != 0) {
+         printf("Error: %s was written in another results format or schema.\n", filename);
+         return false;
+     }
+     
+     return true;
+ }
+ 
+ bool appendResults(const char *filename, ResultsFormat format, const ResultRow *rows, int count) {
+     unsigned char header[1024];
+     size_t headerSize = encodeHeader(format, header, sizeof(header));
+     
+     if (!prepareResultsFile(filename, header, headerSize)) {
+         return false;
+     }
+     
+     unsigned char *batch = malloc((size_t)count * CSV_ROW_LENGTH + 8);
+     if (batch == NULL) {
+         printf("Error allocating memory for results.\n");
+         return false;
+     }
+     size_t batchSize = encodeBatch(format, rows, count, batch);
+     
+     int fd = open(filename, O_WRONLY | O_APPEND);
+     if (fd < 0) {
+         printf("Error opening results file: %s\n", filename);
+         free(batch);
+         return false;
+     }
+     
+     // One write per run: a short write cannot be completed without
+     // interleaving with other writers, so it is reported instead
+     ssize_t written = write(fd, batch, batchSize);
+     bool ok = (written == (ssize_t)batchSize);
+     ok = (close(fd) == 0) && ok;
+     free(batch);
+     
+     if (!ok) {
+         printf("Error writing results to %s\n", filename);
+     }
+     return ok;
+ }
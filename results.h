@@ -0,0 +1,74 @@
+/**
+ * results.h - Typed per-run result rows in append-only result files
+ */
+
+ #ifndef RESULTS_H
+ #define RESULTS_H
+ 
+ #include <stdint.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "scheduler.h"
+ #include "task_set.h"
+ 
+ // Result file formats
+ typedef enum {
+     RESULTS_FORMAT_CSV,       // Header line, then one text line per row
+     RESULTS_FORMAT_COLUMNAR   // Binary schema header, then one column-major block per run
+ } ResultsFormat;
+ 
+ // Columnar file layout (all integers little-endian):
+ //   file header: magic, version, column count, then per column its type and
+ //                a NUL-padded name of RESULTS_NAME_LENGTH bytes
+ //   block:       block magic, row count, then each column's values in turn
+ #define RESULTS_FILE_MAGIC     0x4c4f4352u  // "RCOL"
+ #define RESULTS_BLOCK_MAGIC    0x4b4c4252u  // "RBLK"
+ #define RESULTS_FORMAT_VERSION 1
+ #define RESULTS_NAME_LENGTH    24
+ 
+ // Column value types
+ typedef enum {
+     RESULTS_U32,    // 4 bytes
+     RESULTS_I32,    // 4 bytes, two's complement
+     RESULTS_F64,    // 8 bytes, IEEE 754
+     RESULTS_HEX32   // 4 bytes, shown in hexadecimal (hashes and flags)
+ } ResultsColumnType;
+ 
+ // Engine options that change the schedule, recorded in every row
+ #define RESULTS_OPTION_RUNTIME         0x01u  // --runtime
+ #define RESULTS_OPTION_DVFS_TABLE      0x02u  // --dvfs-table
+ #define RESULTS_OPTION_MC_DEGRADE      0x04u  // --mc-policy degrade
+ #define RESULTS_OPTION_NO_EDF_VD       0x08u  // --no-edf-vd
+ #define RESULTS_OPTION_NO_MC_BOOST     0x10u  // --no-mc-boost
+ #define RESULTS_OPTION_NO_THROTTLE     0x20u  // --no-thermal-throttle
+ 
+ #define RESULTS_RUN_ROW (-1)  // Task column of the row summarising the whole run
+ 
+ // One result row: the run as a whole, or one task of it. Run-wide columns
+ // are repeated on the task rows.
+ typedef struct {
+     uint32_t configHash;          // Options and static task parameters
+     uint32_t inputHash;           // Checkpoint fingerprint: task set, execution times, arrivals
+     uint32_t options;             // RESULTS_OPTION_* bits
+     int32_t task;                 // Task ID, or RESULTS_RUN_ROW
+     uint32_t ticks;
+     double energy;
+     uint32_t ticksAtFrequency[DVFS_LEVELS];
+     uint32_t ticksPowerDown;
+     double powerDownResidency;    // ticksPowerDown / ticks
+     uint32_t completed;
+     uint32_t misses;
+     double responseMean;
+     uint32_t responseP50;
+     uint32_t responseP95;
+     uint32_t responseP99;
+     uint32_t responseMax;
+ } ResultRow;
+ 
+ #define RESULTS_MAX_ROWS (MAX_TASKS + 1)
+ 
+ // Function prototypes
+ int buildResultRows(const TaskSet *taskSet, const SchedulerStats *stats, uint32_t options, ResultRow *rows);
+ bool appendResults(const char *filename, ResultsFormat format, const ResultRow *rows, int count);
+ 
+ #endif /* RESULTS_H */
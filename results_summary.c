@@ -0,0 +1,420 @@
+/**
+ * results_summary.c - Group-by summaries of result files
+ *
+ * Reads the rows that runs appended with --results, in CSV or columnar
+ * format, groups them by one or more columns and prints the mean, minimum
+ * and maximum of a set of metric columns for every group:
+ *
+ *   results_summary [--by COLUMN]... [--metric COLUMN]... [--task ID] FILE...
+ *
+ * Rows are grouped by config_hash unless --by is given. Only the rows that
+ * summarise whole runs are used unless --task selects one task's rows.
+ * Files of both formats can be mixed; columns are matched by name.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <stdbool.h>
+ #include "results.h"
+ 
+ #define MAX_GROUP_COLUMNS 4
+ #define MAX_METRICS 16
+ #define MAX_COLUMNS 64
+ #define LINE_LENGTH 1024
+ 
+ // Columns picked from the files, by name
+ typedef struct {
+     const char *groupBy[MAX_GROUP_COLUMNS];
+     int groupCount;
+     const char *metrics[MAX_METRICS];
+     int metricCount;
+     bool groupHex[MAX_GROUP_COLUMNS];   // Show the group value in hexadecimal
+     double task;                        // Value of the task column to keep
+ } Selection;
+ 
+ // Selected values of every kept row: group values first, then metrics
+ typedef struct {
+     double *values;
+     size_t rows;
+     size_t capacity;
+     size_t rowsRead;
+ } RowStore;
+ 
+ // Schema of the file being read
+ typedef struct {
+     char names[MAX_COLUMNS][RESULTS_NAME_LENGTH];
+     ResultsColumnType types[MAX_COLUMNS];
+     int count;
+     int taskColumn;
+     int groupColumns[MAX_GROUP_COLUMNS];
+     int metricColumns[MAX_METRICS];
+ } Schema;
+ 
+ static int rowStride;  // Values per stored row, for the sort comparator
+ 
+ static int findColumn(const Schema *schema, const char *name) {
+     for (int c = 0; c < schema->count; c++) {
+         if (strcmp(schema->names[c], name) == 0) {
+             return c;
+         }
+     }
+     return -1;
+ }
+ 
+ static bool resolveColumns(const char *filename, Schema *schema, Selection *selection) {
+     schema->taskColumn = findColumn(schema, "task");
+     if (schema->taskColumn < 0) {
+         printf("Error: %s has no task column.\n", filename);
+         return false;
+     }
+     
+     for (int i = 0; i < selection->groupCount; i++) {
+         schema->groupColumns[i] = findColumn(schema, selection->groupBy[i]);
+         if (schema->groupColumns[i] < 0) {
+             printf("Error: %s has no column %s.\n", filename, selection->groupBy[i]);
+             return false;
+         }
+         if (schema->types[schema->groupColumns[i]] == RESULTS_HEX32) {
+             selection->groupHex[i] = true;
+         }
+     }
+     
+     for (int i = 0; i < selection->metricCount; i++) {
+         schema->metricColumns[i] = findColumn(schema, selection->metrics[i]);
+         if (schema->metricColumns[i] < 0) {
+             printf("Error: %s has no column %s.\n", filename, selection->metrics[i]);
+             return false;
+         }
+     }
+     
+     return true;
+ }
+ 
+ // Keep the selected values of one row if it belongs to the selected task
+ static bool storeRow(RowStore *store, const Schema *schema, const Selection *selection, const double *row) {
+     store->rowsRead++;
+     if (row[schema->taskColumn] != selection->task) {
+         return true;
+     }
+     
+     if (store->rows == store->capacity) {
+         size_t capacity = store->capacity > 0 ? store->capacity * 2 : 1024;
+         double *grown = realloc(store->values, capacity * rowStride * sizeof(double));
+         if (grown == NULL) {
+             printf("Error allocating memory for result rows.\n");
+             return false;
+         }
+         store->values = grown;
+         store->capacity = capacity;
+     }
+     
+     double *values = &store->values[store->rows * rowStride];
+     for (int i = 0; i < selection->groupCount; i++) {
+         values[i] = row[schema->groupColumns[i]];
+     }
+     for (int i = 0; i < selection->metricCount; i++) {
+         values[selection->groupCount + i] = row[schema->metricColumns[i]];
+     }
+     store->rows++;
+     return true;
+ }
+ 
+ static bool readCSVFile(const char *filename, FILE *file, RowStore *store, Selection *selection) {
+     Schema schema;
+     char line[LINE_LENGTH];
+     memset(&schema, 0, sizeof(Schema));
+     
+     // Header line; hash and flag columns are recognised by their 0x values
+     if (fgets(line, sizeof(line), file) == NULL) {
+         printf("Error: %s is empty.\n", filename);
+         return false;
+     }
+     for (char *name = strtok(line, ",\n"); name != NULL && schema.count < MAX_COLUMNS; name = strtok(NULL, ",\n")) {
+         strncpy(schema.names[schema.count], name, RESULTS_NAME_LENGTH - 1);
+         schema.types[schema.count++] = RESULTS_F64;
+     }
+     
+     bool typesKnown = false;
+     double row[MAX_COLUMNS];
+     unsigned long lineNumber = 1;
+     
+     while (fgets(line, sizeof(line), file) != NULL) {
+         lineNumber++;
+         char *cursor = line;
+         
+         for (int c = 0; c < schema.count; c++) {
+             char *end;
+             row[c] = strtod(cursor, &end);
+             if (end == cursor || (*end != ',' && c < schema.count - 1)) {
+                 printf("Error: malformed row at %s:%lu\n", filename, lineNumber);
+                 return false;
+             }
+             if (!typesKnown && strncmp(cursor, "0x", 2) == 0) {
+                 schema.types[c] = RESULTS_HEX32;
+             }
+             cursor = end + 1;
+         }
+         
+         if (!typesKnown) {
+             typesKnown = true;
+             if (!resolveColumns(filename, &schema, selection)) {
+                 return false;
+             }
+         }
+         if (!storeRow(store, &schema, selection, row)) {
+             return false;
+         }
+     }
+     
+     return true;
+ }
+ 
+ static uint32_t getU32(const unsigned char *bytes) {
+     return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+            ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+ }
+ 
+ static double decodeValue(const unsigned char *bytes, ResultsColumnType type) {
+     switch (type) {
+         case RESULTS_F64: {
+             uint64_t bits = (uint64_t)getU32(bytes) | ((uint64_t)getU32(bytes + 4) << 32);
+             double value;
+             memcpy(&value, &bits, sizeof(value));
+             return value;
+         }
+         case RESULTS_I32:
+             return (double)(int32_t)getU32(bytes);
+         case RESULTS_U32:
+         case RESULTS_HEX32:
+         default:
+             return (double)getU32(bytes);
+     }
+ }
+ 
+ static bool readColumnarFile(const char *filename, FILE *file, RowStore *store, Selection *selection) {
+     Schema schema;
+     unsigned char bytes[RESULTS_NAME_LENGTH];
+     memset(&schema, 0, sizeof(Schema));
+     
+     if (fread(bytes, 12, 1, file) != 1 || getU32(bytes) != RESULTS_FILE_MAGIC ||
+         getU32(bytes + 4) != RESULTS_FORMAT_VERSION || getU32(bytes + 8) > MAX_COLUMNS) {
+         printf("Error: %s is not a version %d columnar results file.\n", filename, RESULTS_FORMAT_VERSION);
+         return false;
+     }
+     schema.count = (int)getU32(bytes + 8);
+     
+     size_t rowWidth = 0;
+     for (int c = 0; c < schema.count; c++) {
+         if (fread(bytes, 4, 1, file) != 1 || getU32(bytes) > RESULTS_HEX32 ||
+             fread(schema.names[c], RESULTS_NAME_LENGTH, 1, file) != 1) {
+             printf("Error: truncated schema in %s\n", filename);
+             return false;
+         }
+         schema.types[c] = (ResultsColumnType)getU32(bytes);
+         schema.names[c][RESULTS_NAME_LENGTH - 1] = '\0';
+         rowWidth += schema.types[c] == RESULTS_F64 ? 8 : 4;
+     }
+     
+     if (!resolveColumns(filename, &schema, selection)) {
+         return false;
+     }
+     
+     // One block per run, decoded a row at a time from its columns
+     unsigned char *block = NULL;
+     size_t blockCapacity = 0;
+     bool ok = true;
+     
+     while (ok && fread(bytes, 8, 1, file) == 1) {
+         size_t rows = getU32(bytes + 4);
+         if (getU32(bytes) != RESULTS_BLOCK_MAGIC) {
+             printf("Error: corrupt block in %s\n", filename);
+             ok = false;
+             break;
+         }
+         
+         if (rows * rowWidth > blockCapacity) {
+             unsigned char *grown = realloc(block, rows * rowWidth);
+             if (grown == NULL) {
+                 printf("Error allocating memory for result rows.\n");
+                 ok = false;
+                 break;
+             }
+             block = grown;
+             blockCapacity = rows * rowWidth;
+         }
+         if (rows > 0 && fread(block, rows * rowWidth, 1, file) != 1) {
+             printf("Error: truncated block in %s\n", filename);
+             ok = false;
+             break;
+         }
+         
+         for (size_t r = 0; ok && r < rows; r++) {
+             double row[MAX_COLUMNS];
+             const unsigned char *column = block;
+             for (int c = 0; c < schema.count; c++) {
+                 size_t width = schema.types[c] == RESULTS_F64 ? 8 : 4;
+                 row[c] = decodeValue(column + r * width, schema.types[c]);
+                 column += rows * width;
+             }
+             ok = storeRow(store, &schema, selection, row);
+         }
+     }
+     
+     free(block);
+     return ok;
+ }
+ 
+ static bool readResultsFile(const char *filename, RowStore *store, Selection *selection) {
+     FILE *file = fopen(filename, "rb");
+     if (file == NULL) {
+         printf("Error opening results file: %s\n", filename);
+         return false;
+     }
+     
+     // Columnar files start with their magic number, CSV files with a column name
+     unsigned char magic[4];
+     bool columnar = fread(magic, sizeof(magic), 1, file) == 1 && getU32(magic) == RESULTS_FILE_MAGIC;
+     rewind(file);
+     
+     bool ok = columnar ? readColumnarFile(filename, file, store, selection)
+                        : readCSVFile(filename, file, store, selection);
+     fclose(file);
+     return ok;
+ }
+ 
+ static int compareGroups(const void *a, const void *b, int groupCount) {
+     const double *x = a;
+     const double *y = b;
+     for (int i = 0; i < groupCount; i++) {
+         if (x[i] != y[i]) {
+             return x[i] < y[i] ? -1 : 1;
+         }
+     }
+     return 0;
+ }
+ 
+ static int groupCountForSort;
+ 
+ static int compareRows(const void *a, const void *b) {
+     return compareGroups(a, b, groupCountForSort);
+ }
+ 
+ static void printSummary(RowStore *store, const Selection *selection) {
+     int groups = 0;
+     
+     // Sort by the group columns, then each group is one run of equal rows
+     groupCountForSort = selection->groupCount;
+     qsort(store->values, store->rows, rowStride * sizeof(double), compareRows);
+     
+     for (size_t first = 0; first < store->rows; groups++) {
+         const double *head = &store->values[first * rowStride];
+         size_t last = first + 1;
+         while (last < store->rows &&
+                compareGroups(head, &store->values[last * rowStride], selection->groupCount) == 0) {
+             last++;
+         }
+         
+         printf("\n");
+         for (int i = 0; i < selection->groupCount; i++) {
+             if (selection->groupHex[i]) {
+                 printf("%s=0x%08lx  ", selection->groupBy[i], (unsigned long)head[i]);
+             } else {
+                 printf("%s=%g  ", selection->groupBy[i], head[i]);
+             }
+         }
+         printf("(%lu rows)\n", (unsigned long)(last - first));
+         printf("  %-24s %14s %14s %14s\n", "metric", "mean", "min", "max");
+         
+         for (int m = 0; m < selection->metricCount; m++) {
+             int column = selection->groupCount + m;
+             double sum = 0.0, minimum = head[column], maximum = head[column];
+             
+             for (size_t r = first; r < last; r++) {
+                 double value = store->values[r * rowStride + column];
+                 sum += value;
+                 minimum = value < minimum ? value : minimum;
+                 maximum = value > maximum ? value : maximum;
+             }
+             printf("  %-24s %14.4f %14.4f %14.4f\n", selection->metrics[m],
+                    sum / (double)(last - first), minimum, maximum);
+         }
+         
+         first = last;
+     }
+     
+     printf("\n%d groups\n", groups);
+ }
+ 
+ static void printUsage(const char *program) {
+     printf("Usage: %s [--by COLUMN]... [--metric COLUMN]... [--task ID] FILE...\n", program);
+ }
+ 
+ int main(int argc, char *argv[]) {
+     Selection selection;
+     RowStore store;
+     const char *files[argc];
+     int fileCount = 0;
+     
+     memset(&selection, 0, sizeof(Selection));
+     memset(&store, 0, sizeof(RowStore));
+     selection.task = RESULTS_RUN_ROW;
+     
+     for (int i = 1; i < argc; i++) {
+         bool hasValue = (i + 1 < argc);
+         
+         if (strcmp(argv[i], "--by") == 0 && hasValue) {
+             if (selection.groupCount == MAX_GROUP_COLUMNS) {
+                 printf("Error: at most %d --by columns.\n", MAX_GROUP_COLUMNS);
+                 return 2;
+             }
+             selection.groupBy[selection.groupCount++] = argv[++i];
+         } else if (strcmp(argv[i], "--metric") == 0 && hasValue) {
+             if (selection.metricCount == MAX_METRICS) {
+                 printf("Error: at most %d --metric columns.\n", MAX_METRICS);
+                 return 2;
+             }
+             selection.metrics[selection.metricCount++] = argv[++i];
+         } else if (strcmp(argv[i], "--task") == 0 && hasValue) {
+             selection.task = strtod(argv[++i], NULL);
+         } else if (argv[i][0] == '-') {
+             printUsage(argv[0]);
+             return 2;
+         } else {
+             files[fileCount++] = argv[i];
+         }
+     }
+     
+     if (fileCount == 0) {
+         printUsage(argv[0]);
+         return 2;
+     }
+     
+     // Routine comparison: configurations side by side
+     if (selection.groupCount == 0) {
+         selection.groupBy[selection.groupCount++] = "config_hash";
+     }
+     if (selection.metricCount == 0) {
+         static const char *defaultMetrics[] = {
+             "energy", "misses", "response_mean", "response_p99", "ticks_at_1.0", "power_down_residency"
+         };
+         for (size_t i = 0; i < sizeof(defaultMetrics) / sizeof(defaultMetrics[0]); i++) {
+             selection.metrics[selection.metricCount++] = defaultMetrics[i];
+         }
+     }
+     rowStride = selection.groupCount + selection.metricCount;
+     
+     for (int i = 0; i < fileCount; i++) {
+         if (!readResultsFile(files[i], &store, &selection)) {
+             free(store.values);
+             return 2;
+         }
+     }
+     
+     printf("%lu rows read from %d file(s), %lu selected (%s)\n", (unsigned long)store.rowsRead, fileCount,
+            (unsigned long)store.rows, selection.task == RESULTS_RUN_ROW ? "run rows" : "task rows");
+     printSummary(&store, &selection);
+     
+     free(store.values);
+     return 0;
+ }
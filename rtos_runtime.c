@@ -0,0 +1,255 @@
+/**
+ * rtos_runtime.c - Event-driven scheduler running on the FreeRTOS API
+ *
+ * Runs the same EDF and DVFS/DPM logic as mainSchedulerLoop, but instead of
+ * stepping every tick the scheduler task sleeps with vTaskDelay until the
+ * next event: a release, a job completion, a CBS budget exhaustion, a change
+ * of the running job's DVFS level, a thermal throttling threshold or the
+ * point where DPM must wake up ahead of a release. While the processor is
+ * powered down the tick is suppressed entirely (tickless idle).
+ *
+ * The only per-tick work is vApplicationTickHook, which charges the elapsed
+ * tick to the current power state in constant time.
+ */
+
+ #include <stdio.h>
+ #include <string.h>
+ #include "FreeRTOS.h"
+ #include "task.h"
+ #include "timers.h"
+ #include "rtos_runtime.h"
+ #include "aperiodic_server.h"
+ #include "trace.h"
+ #include "mixed_criticality.h"
+ 
+ // State shared with the tick hook; only touched inside critical sections
+ static SchedulerStats *hookStats = NULL;
+ static PowerState *hookPowerState = NULL;
+ static volatile bool endOfRun = false;
+ 
+ void vApplicationTickHook(void) {
+     // Charge the tick that just elapsed to the current power state
+     if (hookStats != NULL) {
+         updateStats(hookStats, hookPowerState, NULL, xTaskGetTickCount() - 1);
+     }
+ }
+ 
+ static void endOfRunCallback(TimerHandle_t xTimer) {
+     (void)xTimer;
+     endOfRun = true;
+ }
+ 
+ // Credit the running job with the ticks it executed since the last event
+ static void creditExecution(Task *task, TickType_t elapsed) {
+     TickType_t progress = elapsed < task->remainingExecutionTime ? elapsed : task->remainingExecutionTime;
+     task->remainingExecutionTime -= progress;
+     serverConsumeBudget(task, elapsed);
+ }
+ 
+ static TickType_t earlierOf(TickType_t a, TickType_t b) {
+     return a < b ? a : b;
+ }
+ 
+ // Level the DVFS policy picks for the running job after another `ticks` ticks of execution
+ static int frequencyIndexAfter(TickType_t work, TickType_t timeToDeadline, TickType_t ticks,
+                                const PowerState *powerState) {
+     int index = selectFrequencyIndex(calculateRequiredFrequency(work - ticks, timeToDeadline - ticks));
+     return index < powerState->frequencyCap ? index : powerState->frequencyCap;
+ }
+ 
+ // Ticks until the DVFS level of the running job changes. Its remaining work
+ // and time to deadline both shrink by one per executed tick, so the required
+ // frequency drifts monotonically and the change is found by bisection.
+ static TickType_t timeToFrequencyChange(const Task *task, const PowerState *powerState) {
+     // A boosted job stays at full speed until the next idle instant
+     if (powerState->isBoosted || task->remainingExecutionTime == 0) {
+         return portMAX_DELAY;
+     }
+     
+     TickType_t work, timeToDeadline;
+     getDVFSDecisionKey(task, &work, &timeToDeadline);
+     
+     // Past the deadline the policy falls back to full speed
+     TickType_t limit = work < timeToDeadline ? work : timeToDeadline;
+     if (limit <= 1) {
+         return portMAX_DELAY;
+     }
+     
+     int index = frequencyIndexAfter(work, timeToDeadline, 0, powerState);
+     if (frequencyIndexAfter(work, timeToDeadline, limit - 1, powerState) == index) {
+         return limit;
+     }
+     
+     TickType_t same = 0, changed = limit - 1;
+     while (changed - same > 1) {
+         TickType_t middle = same + (changed - same) / 2;
+         if (frequencyIndexAfter(work, timeToDeadline, middle, powerState) == index) {
+             same = middle;
+         } else {
+             changed = middle;
+         }
+     }
+     
+     return changed;
+ }
+ 
+ // Time of the next event the scheduler must handle
+ static TickType_t nextEventTime(TaskSet *taskSet, Task *currentTask, PowerState *powerState,
+                                 const ThermalModel *thermal, PowerDecision decision,
+                                 TickType_t slack, TickType_t currentTime, TickType_t simulationEndTime) {
+     TickType_t nextEvent = simulationEndTime + 1;
+     ReleaseEvent nextRelease;
+     
+     if (eventQueuePeek(&taskSet->releaseQueue, &nextRelease)) {
+         nextEvent = earlierOf(nextEvent, nextRelease.time);
+     }
+     
+     // Die temperature crossing a throttling threshold
+     nextEvent = earlierOf(nextEvent, thermal->nextEventTime);
+     
+     if (currentTask != NULL) {
+         // Completion, or CBS budget exhaustion which postpones the deadline
+         TickType_t remaining = currentTask->remainingExecutionTime > 0 ? currentTask->remainingExecutionTime : 1;
+         nextEvent = earlierOf(nextEvent, currentTime + remaining);
+         
+         if (currentTask->kind == TASK_SERVER_CBS && currentTask->serverBudget > 0) {
+             nextEvent = earlierOf(nextEvent, currentTime + currentTask->serverBudget);
+         }
+         
+         // Required frequency drifting across a level boundary
+         TickType_t frequencyChange = timeToFrequencyChange(currentTask, powerState);
+         if (frequencyChange != portMAX_DELAY) {
+             nextEvent = earlierOf(nextEvent, currentTime + frequencyChange);
+         }
+         
+         // HI job overrunning its LO budget switches the criticality mode
+         TickType_t overrun = timeToBudgetOverrun(taskSet, currentTask);
+         if (overrun != portMAX_DELAY) {
+             nextEvent = earlierOf(nextEvent, currentTime + overrun);
+         }
+         
+         // Just woken from DPM: pick the frequency on the next tick
+         if (decision.type == POWER_DPM_OFF) {
+             nextEvent = earlierOf(nextEvent, currentTime + 1);
+         }
+     } else if (powerState->isDPMActive && slack != portMAX_DELAY && slack > DPM_THRESHOLD) {
+         // Leave DPM once the slack drops to the threshold
+         nextEvent = earlierOf(nextEvent, currentTime + (slack - DPM_THRESHOLD));
+     }
+     
+     return nextEvent > currentTime ? nextEvent : currentTime + 1;
+ }
+ 
+ void runtimeSchedulerLoop(TaskSet *taskSet, PowerState *powerState, SchedulerStats *stats,
+                           ThermalModel *thermal, FILE *outputFile, FILE *traceFile, RuntimeStats *runtimeStats) {
+     TickType_t simulationEndTime = calculateSimulationEndTime(taskSet);
+     TickType_t lastEventTime = 0;
+     Task *currentTask = NULL;
+     
+     memset(runtimeStats, 0, sizeof(RuntimeStats));
+     
+     fprintf(outputFile, "Time | Running Task | Frequency | Power Mode | Slack | Decision\n");
+     fprintf(outputFile, "----------------------------------------------------------\n");
+     
+     hookStats = stats;
+     hookPowerState = powerState;
+     endOfRun = false;
+     
+     vTaskStartScheduler();
+     
+     // One-shot timer marking the end of the run
+     TimerHandle_t endTimer = xTimerCreate("RunEnd", simulationEndTime + 1, tmrONE_SHOT, NULL, endOfRunCallback);
+     if (endTimer == NULL || xTimerStart(endTimer, 0) != pdPASS) {
+         printf("Error creating end-of-run timer.\n");
+         vTaskEndScheduler();
+         hookStats = NULL;
+         return;
+     }
+     
+     while (true) {
+         taskENTER_CRITICAL();
+         TickType_t currentTime = xTaskGetTickCount();
+         runtimeStats->schedulerEvents++;
+         
+         // Completion event
+         if (currentTask != NULL) {
+             creditExecution(currentTask, currentTime - lastEventTime);
+         }
+         checkForTaskCompletions(taskSet, currentTime);
+         checkForBudgetOverruns(taskSet, powerState, currentTime);
+         
+         if (endOfRun || currentTime > simulationEndTime) {
+             hookStats = NULL;
+             taskEXIT_CRITICAL();
+             break;
+         }
+         
+         // Release event
+         checkForTaskArrivals(taskSet, currentTime);
+         
+         // Same decisions as the simulation loop, taken once per event
+         currentTask = getHighestPriorityTask(taskSet);
+         if (currentTask == NULL) {
+             checkForModeReturn(taskSet, powerState, currentTime);
+         }
+         TickType_t slack = calculateSystemSlack(taskSet, currentTime);
+         updateThermalThrottle(thermal, powerState, currentTime);
+         
+         PowerDecision decision;
+         if (currentTask == NULL) {
+             decision = makeDPMDecision(slack, powerState);
+         } else {
+             decision = makeDVFSDecision(currentTask, slack, powerState);
+         }
+         applyPowerDecision(&decision, powerState);
+         updateThermalModel(thermal, powerState, currentTime);
+         
+         logSchedulerState(outputFile, currentTime, currentTask, *powerState, slack, decision);
+         if (traceFile != NULL) {
+             writeTraceState(traceFile, currentTime, currentTask, *powerState, slack, decision);
+         }
+         
+         TickType_t nextEvent = nextEventTime(taskSet, currentTask, powerState, thermal, decision,
+                                              slack, currentTime, simulationEndTime);
+         bool ticklessIdle = (currentTask == NULL && powerState->isDPMActive);
+         lastEventTime = currentTime;
+         taskEXIT_CRITICAL();
+         
+         if (!ticklessIdle) {
+             vTaskDelay(nextEvent - currentTime);
+             continue;
+         }
+         
+         // Powered down: stop the tick until the next event
+         PortTickStats before, after;
+         vPortGetTickStats(&before);
+         portSUPPRESS_TICKS_AND_SLEEP(nextEvent - currentTime);
+         vPortGetTickStats(&after);
+         
+         // Ticks that were slept through never reached the tick hook
+         TickType_t suppressed = (TickType_t)(after.ticksSuppressed - before.ticksSuppressed);
+         if (suppressed > 0) {
+             runtimeStats->ticklessEntries++;
+             taskENTER_CRITICAL();
+             updateStatsForTicks(stats, powerState, currentTime, suppressed);
+             taskEXIT_CRITICAL();
+         }
+     }
+     
+     xTimerStop(endTimer, 0);
+     vTaskEndScheduler();
+     vPortGetTickStats(&runtimeStats->tickStats);
+ }
+ 
+ void logRuntimeStats(FILE *file, const RuntimeStats *runtimeStats) {
+     const PortTickStats *tickStats = &runtimeStats->tickStats;
+     
+     fprintf(file, "Runtime mode (host port, %d Hz tick):\n", configTICK_RATE_HZ);
+     fprintf(file, "  - Scheduler events: %u\n", runtimeStats->schedulerEvents);
+     fprintf(file, "  - Tick interrupts taken: %llu\n", (unsigned long long)tickStats->ticksProcessed);
+     fprintf(file, "  - Ticks suppressed by tickless idle: %llu (%u idle periods)\n",
+             (unsigned long long)tickStats->ticksSuppressed, runtimeStats->ticklessEntries);
+     fprintf(file, "  - Tick cost: average %.0f ns, maximum %llu ns\n",
+             tickStats->ticksProcessed > 0 ? (double)tickStats->tickTotalNs / tickStats->ticksProcessed : 0.0,
+             (unsigned long long)tickStats->tickMaxNs);
+ }
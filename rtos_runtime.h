@@ -0,0 +1,28 @@
+/**
+ * rtos_runtime.h - Event-driven scheduler running on the FreeRTOS API
+ */
+
+ #ifndef RTOS_RUNTIME_H
+ #define RTOS_RUNTIME_H
+ 
+ #include <stdio.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "scheduler.h"
+ #include "task_set.h"
+ #include "thermal.h"
+ 
+ // Runtime mode statistics
+ typedef struct {
+     unsigned int schedulerEvents;   // Times the scheduler ran (releases, completions, DPM wake-ups)
+     unsigned int ticklessEntries;   // Times the tick was suppressed for DPM idle
+     PortTickStats tickStats;        // Tick interrupt cost measured by the port
+ } RuntimeStats;
+ 
+ // Function prototypes
+ void runtimeSchedulerLoop(TaskSet *taskSet, PowerState *powerState, SchedulerStats *stats,
+                           ThermalModel *thermal, FILE *outputFile, FILE *traceFile,
+                           RuntimeStats *runtimeStats);
+ void logRuntimeStats(FILE *file, const RuntimeStats *runtimeStats);
+ 
+ #endif /* RTOS_RUNTIME_H */
@@ -0,0 +1,491 @@
+/**
+ * schedule_diff.c - Differential replay of two scheduler runs
+ *
+ * Compares the schedules produced by two engine configurations and reports
+ * the first point where they diverge, followed by a summary of how their
+ * metrics differ. Either two trace files written with --trace are compared,
+ * or both engines are started here and their traces are read through pipes
+ * while they run:
+ *
+ *   schedule_diff [--engine PATH] --run "ARGS A" "ARGS B"
+ *   schedule_diff TRACE_A TRACE_B
+ *
+ * Both traces are streamed with one record of lookahead each, so memory use
+ * does not depend on the length of the run.
+ *
+ * A trace only holds a record when the engine logged one: every tick for
+ * the simulation loop, every scheduler event for the runtime mode. Between
+ * its records a run keeps its last state, with the running job retiring one
+ * unit of work per tick. The two runs are compared at every time either of
+ * them logged a record, which is enough to find every tick where they
+ * differ. Slack and the power decision are only compared where both runs
+ * logged a record at the same time.
+ */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <stdbool.h>
+ #include <unistd.h>
+ #include <fcntl.h>
+ #include <sys/types.h>
+ #include <sys/wait.h>
+ #include "trace.h"
+ 
+ #define LINE_LENGTH 256
+ 
+ // One state record from a trace
+ typedef struct {
+     bool valid;
+     unsigned long time;
+     int taskId;                // -1 when no task is running
+     unsigned long remaining;
+     unsigned long deadline;
+     double frequency;
+     int dpmActive;
+     char slack[16];
+     char decision[16];
+ } StateRecord;
+ 
+ // A trace being read
+ typedef struct {
+     const char *name;
+     FILE *file;
+     pid_t pid;                  // Engine started by --run, or 0
+     char logPath[64];           // Console log of that engine, removed when finished
+     StateRecord current;        // State in effect
+     StateRecord next;           // Lookahead
+     char metricLine[LINE_LENGTH]; // First metric record, read while looking for a state record
+     bool metricPending;
+     unsigned long long records;
+     bool malformed;
+ } TraceStream;
+ 
+ // State of a run at a given time
+ typedef struct {
+     bool present;
+     int taskId;
+     unsigned long remaining;
+     unsigned long deadline;
+     double frequency;
+     int dpmActive;
+     bool logged;                // A record was logged at exactly this time
+     const StateRecord *record;
+ } RunState;
+ 
+ static bool parseStateRecord(const char *line, StateRecord *record) {
+     char task[16];
+     
+     if (sscanf(line, "S %lu %15s %lu %lu %lf %d %15s %15s", &record->time, task, &record->remaining,
+                &record->deadline, &record->frequency, &record->dpmActive,
+                record->slack, record->decision) != 8) {
+         return false;
+     }
+     
+     record->taskId = (strcmp(task, "-") == 0) ? -1 : atoi(task);
+     record->valid = true;
+     return true;
+ }
+ 
+ // Read the next state record; stops at the first metric record
+ static void readStateRecord(TraceStream *stream, StateRecord *record) {
+     char line[LINE_LENGTH];
+     record->valid = false;
+     
+     while (!stream->metricPending && fgets(line, sizeof(line), stream->file) != NULL) {
+         if (line[0] == '#' || line[0] == '\n') {
+             // Reject traces written in another format version
+             if (strncmp(line, "# schedule trace", 16) == 0 &&
+                 strncmp(line, TRACE_FORMAT_HEADER, strlen(TRACE_FORMAT_HEADER)) != 0) {
+                 stream->malformed = true;
+             }
+             continue;
+         }
+         if (line[0] == 'M') {
+             strcpy(stream->metricLine, line);
+             stream->metricPending = true;
+             return;
+         }
+         if (parseStateRecord(line, record)) {
+             stream->records++;
+             return;
+         }
+         stream->malformed = true;
+     }
+ }
+ 
+ static bool readMetric(TraceStream *stream, char *name, double *value) {
+     char line[LINE_LENGTH];
+     
+     while (true) {
+         if (stream->metricPending) {
+             strcpy(line, stream->metricLine);
+             stream->metricPending = false;
+         } else if (fgets(line, sizeof(line), stream->file) == NULL) {
+             return false;
+         }
+         
+         if (sscanf(line, "M %63s %lf", name, value) == 2) {
+             return true;
+         }
+         // State records left over when the schedule comparison stopped early
+         if (line[0] != '#' && line[0] != '\n' && line[0] != 'S') {
+             stream->malformed = true;
+         }
+     }
+ }
+ 
+ static bool openTrace(TraceStream *stream, const char *name, const char *filename) {
+     stream->name = name;
+     stream->file = fopen(filename, "r");
+     if (stream->file == NULL) {
+         printf("Error opening trace file: %s\n", filename);
+         return false;
+     }
+     return true;
+ }
+ 
+ // Start the engine with its trace written to a pipe
+ static bool startEngine(TraceStream *stream, const char *name, const char *engine,
+                         const char *arguments, const char *workDirectory) {
+     int fds[2];
+     if (pipe(fds) != 0) {
+         printf("Error creating pipe for run %s.\n", name);
+         return false;
+     }
+     // Keep the read end out of the other engine, or it never sees end of file
+     fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+     
+     // Only the trace is compared; the per-tick log and analysis are not kept
+     snprintf(stream->logPath, sizeof(stream->logPath), "%s/%s.log", workDirectory, name);
+     char command[4096];
+     snprintf(command, sizeof(command),
+              "exec %s %s --trace /dev/fd/3 --output /dev/null --analysis /dev/null > %s 2>&1",
+              engine, arguments, stream->logPath);
+     
+     pid_t pid = fork();
+     if (pid < 0) {
+         printf("Error starting run %s.\n", name);
+         stream->logPath[0] = '\0';
+         close(fds[0]);
+         close(fds[1]);
+         return false;
+     }
+     
+     if (pid == 0) {
+         close(fds[0]);
+         if (fds[1] != 3) {
+             dup2(fds[1], 3);
+             close(fds[1]);
+         }
+         execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+         _exit(127);
+     }
+     
+     close(fds[1]);
+     stream->name = name;
+     stream->pid = pid;
+     stream->file = fdopen(fds[0], "r");
+     return stream->file != NULL;
+ }
+ 
+ static void stateAt(const TraceStream *stream, unsigned long time, RunState *state) {
+     const StateRecord *record = &stream->current;
+     memset(state, 0, sizeof(RunState));
+     
+     if (!record->valid || record->time > time) {
+         return;
+     }
+     
+     unsigned long elapsed = time - record->time;
+     state->present = true;
+     state->taskId = record->taskId;
+     state->deadline = record->deadline;
+     state->frequency = record->frequency;
+     state->dpmActive = record->dpmActive;
+     state->remaining = record->taskId >= 0 && record->remaining > elapsed ? record->remaining - elapsed : 0;
+     state->logged = (elapsed == 0);
+     state->record = record;
+ }
+ 
+ static bool statesMatch(const RunState *a, const RunState *b) {
+     if (a->present != b->present) {
+         return false;
+     }
+     if (!a->present) {
+         return true;
+     }
+     
+     bool match = a->taskId == b->taskId && a->dpmActive == b->dpmActive &&
+                  a->frequency == b->frequency;
+     if (match && a->taskId >= 0) {
+         match = a->remaining == b->remaining && a->deadline == b->deadline;
+     }
+     if (match && a->logged && b->logged) {
+         match = strcmp(a->record->slack, b->record->slack) == 0 &&
+                 strcmp(a->record->decision, b->record->decision) == 0;
+     }
+     return match;
+ }
+ 
+ static void printRunState(const char *name, const RunState *state) {
+     if (!state->present) {
+         printf("  %s: no state logged yet\n", name);
+         return;
+     }
+     
+     if (state->taskId >= 0) {
+         printf("  %s: running task %d, remaining %lu, deadline %lu", name,
+                state->taskId, state->remaining, state->deadline);
+     } else {
+         printf("  %s: idle", name);
+     }
+     printf(", frequency %.1f, %s", state->frequency, state->dpmActive ? "power-down" : "active");
+     
+     if (state->logged) {
+         printf(", slack %s, decision %s\n", state->record->slack, state->record->decision);
+     } else {
+         printf(" (carried from time %lu)\n", state->record->time);
+     }
+ }
+ 
+ static void advance(TraceStream *stream) {
+     stream->current = stream->next;
+     readStateRecord(stream, &stream->next);
+ }
+ 
+ // Walk both schedules; returns true if they are identical
+ static bool compareSchedules(TraceStream *a, TraceStream *b) {
+     unsigned long long divergentTicks = 0;
+     unsigned long long divergentIntervals = 0;
+     bool diverged = false;
+     bool previousMatched = true;
+     
+     readStateRecord(a, &a->current);
+     readStateRecord(b, &b->current);
+     readStateRecord(a, &a->next);
+     readStateRecord(b, &b->next);
+     
+     if (!a->current.valid || !b->current.valid) {
+         printf("Schedule: run %s has no state records.\n", !a->current.valid ? a->name : b->name);
+         return false;
+     }
+     
+     unsigned long time = a->current.time < b->current.time ? a->current.time : b->current.time;
+     unsigned long lastTime = time;
+     
+     while (true) {
+         RunState stateA, stateB;
+         stateAt(a, time, &stateA);
+         stateAt(b, time, &stateB);
+         
+         // The states hold until either run logs its next record
+         bool more = a->next.valid || b->next.valid;
+         unsigned long nextTime = time + 1;
+         if (more) {
+             nextTime = !a->next.valid ? b->next.time :
+                        !b->next.valid ? a->next.time :
+                        (a->next.time < b->next.time ? a->next.time : b->next.time);
+         }
+         
+         if (!statesMatch(&stateA, &stateB)) {
+             if (!diverged) {
+                 printf("First divergence at time %lu", time);
+                 if (time > 0) {
+                     printf(" (schedules agree up to time %lu)", time - 1);
+                 }
+                 printf(":\n");
+                 printRunState(a->name, &stateA);
+                 printRunState(b->name, &stateB);
+                 diverged = true;
+             }
+             if (previousMatched) {
+                 divergentIntervals++;
+             }
+             divergentTicks += nextTime - time;
+             previousMatched = false;
+         } else {
+             previousMatched = true;
+         }
+         
+         lastTime = time;
+         if (!more) {
+             break;
+         }
+         
+         if (a->next.valid && a->next.time == nextTime) {
+             advance(a);
+         }
+         if (b->next.valid && b->next.time == nextTime) {
+             advance(b);
+         }
+         time = nextTime;
+     }
+     
+     printf("Schedule: %llu records from %s, %llu records from %s, compared up to time %lu\n",
+            a->records, a->name, b->records, b->name, lastTime);
+     if (diverged) {
+         printf("Schedule: %llu ticks differ in %llu intervals\n", divergentTicks, divergentIntervals);
+     } else {
+         printf("Schedule: identical\n");
+     }
+     
+     return !diverged;
+ }
+ 
+ // Compare the metric records that close both traces; returns true if identical
+ static bool compareMetrics(TraceStream *a, TraceStream *b) {
+     char nameA[64], nameB[64];
+     double valueA, valueB;
+     unsigned int identical = 0, different = 0;
+     
+     printf("\nMetrics:\n");
+     while (true) {
+         bool hasA = readMetric(a, nameA, &valueA);
+         bool hasB = readMetric(b, nameB, &valueB);
+         
+         if (!hasA && !hasB) {
+             break;
+         }
+         if (!hasA || !hasB || strcmp(nameA, nameB) != 0) {
+             printf("  metric lists differ at %s / %s\n", hasA ? nameA : "(end)", hasB ? nameB : "(end)");
+             different++;
+             break;
+         }
+         
+         if (valueA == valueB) {
+             identical++;
+             continue;
+         }
+         
+         if (different == 0) {
+             printf("  %-24s %14s %14s %14s\n", "metric", a->name, b->name, "difference");
+         }
+         printf("  %-24s %14.4f %14.4f %+14.4f\n", nameA, valueA, valueB, valueB - valueA);
+         different++;
+     }
+     
+     printf("  %u identical, %u different\n", identical, different);
+     return different == 0;
+ }
+ 
+ // Show the console log of a failed engine
+ static void printLog(const TraceStream *stream) {
+     FILE *file = fopen(stream->logPath, "r");
+     if (file == NULL) {
+         return;
+     }
+     
+     char line[LINE_LENGTH];
+     printf("Log of run %s:\n", stream->name);
+     while (fgets(line, sizeof(line), file) != NULL) {
+         printf("  %s", line);
+     }
+     fclose(file);
+ }
+ 
+ static bool finishStream(TraceStream *stream) {
+     bool ok = !stream->malformed;
+     
+     if (stream->malformed) {
+         printf("Warning: run %s has malformed trace records.\n", stream->name);
+     }
+     
+     if (stream->file != NULL) {
+         // Drain so the engine is never left blocked on a full pipe
+         char line[LINE_LENGTH];
+         while (fgets(line, sizeof(line), stream->file) != NULL) {
+         }
+         fclose(stream->file);
+     }
+     
+     if (stream->pid > 0) {
+         int status;
+         if (waitpid(stream->pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+             printf("Error: run %s did not finish successfully.\n", stream->name);
+             ok = false;
+         }
+     }
+     
+     if (stream->logPath[0] != '\0') {
+         if (!ok) {
+             printLog(stream);
+         }
+         unlink(stream->logPath);
+     }
+     
+     return ok;
+ }
+ 
+ static void printUsage(const char *program) {
+     printf("Usage: %s [--engine PATH] --run \"ARGS A\" \"ARGS B\"\n"
+            "       %s TRACE_A TRACE_B\n", program, program);
+ }
+ 
+ int main(int argc, char *argv[]) {
+     const char *engine = "./dvfs_dpm_scheduler";
+     const char *inputs[2] = {NULL, NULL};
+     int inputCount = 0;
+     bool runEngines = false;
+     
+     for (int i = 1; i < argc; i++) {
+         if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+             engine = argv[++i];
+         } else if (strcmp(argv[i], "--run") == 0) {
+             runEngines = true;
+         } else if (inputCount < 2) {
+             inputs[inputCount++] = argv[i];
+         } else {
+             printUsage(argv[0]);
+             return 2;
+         }
+     }
+     
+     if (inputCount != 2) {
+         printUsage(argv[0]);
+         return 2;
+     }
+     
+     TraceStream a, b;
+     memset(&a, 0, sizeof(TraceStream));
+     memset(&b, 0, sizeof(TraceStream));
+     
+     // Holds the engines' console logs while they run
+     char workDirectory[] = "/tmp/schedule_diff.XXXXXX";
+     
+     if (runEngines) {
+         if (mkdtemp(workDirectory) == NULL) {
+             printf("Error creating working directory.\n");
+             return 2;
+         }
+         
+         if (!startEngine(&a, "A", engine, inputs[0], workDirectory) ||
+             !startEngine(&b, "B", engine, inputs[1], workDirectory)) {
+             finishStream(&a);
+             finishStream(&b);
+             rmdir(workDirectory);
+             return 2;
+         }
+         printf("A: %s %s\nB: %s %s\n\n", engine, inputs[0], engine, inputs[1]);
+     } else {
+         if (!openTrace(&a, "A", inputs[0]) || !openTrace(&b, "B", inputs[1])) {
+             finishStream(&a);
+             finishStream(&b);
+             return 2;
+         }
+         printf("A: %s\nB: %s\n\n", inputs[0], inputs[1]);
+     }
+     
+     bool sameSchedule = compareSchedules(&a, &b);
+     bool sameMetrics = compareMetrics(&a, &b);
+     bool okA = finishStream(&a);
+     bool okB = finishStream(&b);
+     if (runEngines) {
+         rmdir(workDirectory);
+     }
+     
+     if (!okA || !okB) {
+         return 2;
+     }
+     return (sameSchedule && sameMetrics) ? 0 : 1;
+ }
@@ -5,20 +5,97 @@
  #include <stdio.h>
  #include <stdlib.h>
  #include "scheduler.h"
+ #include "aperiodic_server.h"
+ #include "mixed_criticality.h"
  
- void checkForTaskArrivals(TaskSet *taskSet, TickType_t currentTime) {
+ // Queue the next release of a task, if it has one
+ static void scheduleNextRelease(TaskSet *taskSet, int taskIndex, TickType_t earliest) {
+     Task *task = &taskSet->tasks[taskIndex];
+     
+     if (task->kind == TASK_PERIODIC) {
+         eventQueuePush(&taskSet->releaseQueue, task->nextArrivalTime, taskIndex);
+         return;
+     }
+     
+     if (task->nextArrival >= task->arrivalCount) {
+         return;  // Trace exhausted
+     }
+     
+     // Sporadic releases are held back to respect the minimum inter-arrival time
+     TickType_t releaseTime = task->arrivals[task->nextArrival].releaseTime;
+     if (releaseTime < earliest) {
+         releaseTime = earliest;
+     }
+     
+     task->nextArrivalTime = releaseTime;
+     eventQueuePush(&taskSet->releaseQueue, releaseTime, taskIndex);
+ }
+ 
+ void initializeReleaseQueue(TaskSet *taskSet) {
+     eventQueueInit(&taskSet->releaseQueue);
+     
      for (int i = 0; i < taskSet->count; i++) {
-         Task *task = &taskSet->tasks[i];
+         scheduleNextRelease(taskSet, i, 0);
+     }
+ }
+ 
+ static void releaseTask(TaskSet *taskSet, int taskIndex, TickType_t currentTime) {
+     Task *task = &taskSet->tasks[taskIndex];
+     
+     task->state = TASK_READY;
+     task->absoluteDeadline = currentTime + task->relativeDeadline;
+     task->arrivalTime = currentTime;
+     
+     if (task->kind == TASK_PERIODIC) {
+         task->instanceExecutionTime = task->actualExecutionTime[task->currentInstance];
          
-         // Check if a new instance of the periodic task should arrive
-         if (currentTime >= task->nextArrivalTime && task->state == TASK_IDLE) {
-             task->state = TASK_READY;
-             task->remainingExecutionTime = task->actualExecutionTime[task->currentInstance];
-             task->absoluteDeadline = currentTime + task->relativeDeadline;
-             task->arrivalTime = currentTime;
-             
-             // Schedule next arrival
-             task->nextArrivalTime += task->period;
+         // Schedule next arrival
+         task->nextArrivalTime += task->period;
+         scheduleNextRelease(taskSet, taskIndex, 0);
+     } else {
+         task->instanceExecutionTime = task->arrivals[task->nextArrival++].executionTime;
+         scheduleNextRelease(taskSet, taskIndex, currentTime + task->period);
+     }
+     
+     task->remainingExecutionTime = task->instanceExecutionTime;
+     task->virtualDeadline = calculateVirtualDeadline(taskSet, task, currentTime);
+ }
+ 
+ // Skip a release that is not admitted in HI mode and move on to the next one
+ static void skipRelease(TaskSet *taskSet, int taskIndex, TickType_t currentTime) {
+     Task *task = &taskSet->tasks[taskIndex];
+     task->jobsDropped++;
+     
+     if (task->kind == TASK_PERIODIC) {
+         task->currentInstance = (task->currentInstance + 1) % MAX_INSTANCES;
+         task->nextArrivalTime += task->period;
+         scheduleNextRelease(taskSet, taskIndex, 0);
+     } else {
+         task->nextArrival++;
+         scheduleNextRelease(taskSet, taskIndex, currentTime + task->period);
+     }
+ }
+ 
+ void checkForTaskArrivals(TaskSet *taskSet, TickType_t currentTime) {
+     ReleaseEvent event;
+     
+     // Only releases that are due are touched, earliest first
+     while (eventQueuePeek(&taskSet->releaseQueue, &event) && event.time <= currentTime) {
+         eventQueuePop(&taskSet->releaseQueue, &event);
+         Task *task = &taskSet->tasks[event.taskIndex];
+         
+         if (isAperiodicServer(task)) {
+             // Aperiodic jobs queue at the server; the next one is traced in behind it
+             serverJobArrival(task, currentTime);
+             scheduleNextRelease(taskSet, event.taskIndex, 0);
+         } else if (task->state == TASK_IDLE && !admitRelease(taskSet, task, currentTime)) {
+             // LO job dropped or thinned out while in HI mode
+             skipRelease(taskSet, event.taskIndex, currentTime);
+         } else if (task->state == TASK_IDLE) {
+             releaseTask(taskSet, event.taskIndex, currentTime);
+         } else {
+             // Previous instance still active: release as soon as it completes
+             task->releasePending = true;
          }
      }
  }
@@ -36,6 +113,10 @@
              // Calculate response time (completion time - arrival time)
              TickType_t responseTime = task->completionTime - task->arrivalTime;
              task->totalResponseTime += responseTime;
+             if (responseTime > task->maxResponseTime) {
+                 task->maxResponseTime = responseTime;
+             }
+             histogramRecord(&taskSet->responseTimes[i], responseTime);
              
              // Check for deadline miss
              if (currentTime > task->absoluteDeadline) {
@@ -47,6 +128,15 @@
              if (task->currentInstance >= MAX_INSTANCES) {
                  task->currentInstance = 0;  // Wrap around
              }
+             
+             if (isAperiodicServer(task)) {
+                 // Serve the next queued aperiodic job, if any
+                 serverDispatchNextJob(task, currentTime);
+             } else if (task->releasePending) {
+                 // Deferred release becomes due on the next arrival check
+                 task->releasePending = false;
+                 eventQueuePush(&taskSet->releaseQueue, currentTime, i);
+             }
          }
      }
  }
@@ -55,13 +145,15 @@
      Task *highestPriorityTask = NULL;
      TickType_t earliestDeadline = portMAX_DELAY;
      
-     // Earliest Deadline First (EDF) scheduling
+     // Earliest Deadline First (EDF) scheduling; HI tasks use their
+     // EDF-VD deadlines in LO mode
      for (int i = 0; i < taskSet->count; i++) {
          Task *task = &taskSet->tasks[i];
          
          if (task->state == TASK_READY || task->state == TASK_RUNNING) {
-             if (task->absoluteDeadline < earliestDeadline) {
-                 earliestDeadline = task->absoluteDeadline;
+             TickType_t deadline = getSchedulingDeadline(taskSet, task);
+             if (deadline < earliestDeadline) {
+                 earliestDeadline = deadline;
                  highestPriorityTask = task;
              }
          }
@@ -94,15 +186,11 @@
      
      // If no tasks are ready, set a maximum slack value
      if (!hasReadyTasks) {
-         // Find minimum time until next task arrival
+         // Time until next task arrival is at the head of the release queue
+         ReleaseEvent nextRelease;
          totalSlack = portMAX_DELAY;
-         for (int i = 0; i < taskSet->count; i++) {
-             if (taskSet->tasks[i].nextArrivalTime > currentTime) {
-                 TickType_t timeUntilNextArrival = taskSet->tasks[i].nextArrivalTime - currentTime;
-                 if (timeUntilNextArrival < totalSlack) {
-                     totalSlack = timeUntilNextArrival;
-                 }
-             }
+         if (eventQueuePeek(&taskSet->releaseQueue, &nextRelease) && nextRelease.time > currentTime) {
+             totalSlack = nextRelease.time - currentTime;
          }
      }
      
@@ -115,13 +203,23 @@
      const int SIMULATION_PERIODS = 3;
      TickType_t maxPeriod = 0;
      
+     TickType_t lastTraceRelease = 0;
+     
      for (int i = 0; i < taskSet->count; i++) {
-         if (taskSet->tasks[i].period > maxPeriod) {
-             maxPeriod = taskSet->tasks[i].period;
+         const Task *task = &taskSet->tasks[i];
+         if (task->period > maxPeriod) {
+             maxPeriod = task->period;
+         }
+         
+         // Make sure every traced release is simulated
+         if (task->arrivalCount > 0 &&
+             task->arrivals[task->arrivalCount - 1].releaseTime + task->period > lastTraceRelease) {
+             lastTraceRelease = task->arrivals[task->arrivalCount - 1].releaseTime + task->period;
          }
      }
      
-     return maxPeriod * SIMULATION_PERIODS;
+     TickType_t endTime = maxPeriod * SIMULATION_PERIODS;
+     return lastTraceRelease > endTime ? lastTraceRelease : endTime;
  }
  
  void executeTask(Task *task, PowerState *powerState, TickType_t *currentTime) {
@@ -135,41 +233,45 @@
          task->remainingExecutionTime = 0;
      }
      
+     // Aperiodic servers pay for the tick out of their budget
+     serverConsumeBudget(task, 1);
+     
      // Advance simulation time
      (*currentTime)++;
  }
  
  void updateStats(SchedulerStats *stats, PowerState *powerState, Task *currentTask, TickType_t currentTime) {
+     (void)currentTask;
+     updateStatsForTicks(stats, powerState, currentTime, 1);
+ }
+ 
+ // Charge `ticks` ticks starting at startTime, all spent in the same power state
+ void updateStatsForTicks(SchedulerStats *stats, const PowerState *powerState, TickType_t startTime, TickType_t ticks) {
+     if (ticks == 0) {
+         return;
+     }
+     
      // Update total execution time
-     stats->totalExecutionTime = currentTime + 1;  // +1 because time is 0-indexed
+     stats->totalExecutionTime = startTime + ticks;  // time is 0-indexed
      
-     // Update time spent at each frequency level
-     if (powerState->frequencyLevel == 1.0) {
-         stats->timeAtFrequency[3]++;
-     } else if (powerState->frequencyLevel == 0.8) {
-         stats->timeAtFrequency[2]++;
-     } else if (powerState->frequencyLevel == 0.6) {
-         stats->timeAtFrequency[1]++;
-     } else if (powerState->frequencyLevel == 0.4) {
-         stats->timeAtFrequency[0]++;
+     // Update time spent at each frequency level (compared as float, the
+     // type the levels are stored in)
+     for (int i = 0; i < DVFS_LEVELS; i++) {
+         if (powerState->frequencyLevel == getFrequencyLevel(i)) {
+             stats->timeAtFrequency[i] += ticks;
+             break;
+         }
      }
      
      // Update time in power-down mode
      if (powerState->isDPMActive) {
-         stats->timeInPowerDown++;
+         stats->timeInPowerDown += ticks;
      }
      
      // Update energy consumption (simple model)
-     // Energy ∝ Voltage² × Frequency
-     float voltage = powerState->frequencyLevel;  // Assuming voltage scales with frequency
-     float energyThisTick = voltage * voltage * powerState->frequencyLevel;
-     
-     // If DPM is active, use static leakage energy only (much lower)
-     if (powerState->isDPMActive) {
-         energyThisTick = 0.05;  // Example static leakage energy value
-     }
+     float energyThisTick = calculateTickEnergy(powerState);
      
-     stats->energyConsumption += energyThisTick;
+     stats->energyConsumption += (double)energyThisTick * ticks;
  }
  
  void logSchedulerState(FILE *file, TickType_t time, Task *task, PowerState powerState, 
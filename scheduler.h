@@ -18,7 +18,7 @@
  // Scheduler statistics structure
  typedef struct {
      TickType_t totalExecutionTime;
-     float energyConsumption;
+     double energyConsumption;       // Summed in double so bulk charging matches per-tick charging
      unsigned int dvfsTransitions;
      unsigned int dpmTransitions;
      TickType_t timeAtFrequency[4];  // Time spent at each frequency level
@@ -26,6 +26,7 @@
  } SchedulerStats;
  
  // Function prototypes
+ void initializeReleaseQueue(TaskSet *taskSet);
  void checkForTaskArrivals(TaskSet *taskSet, TickType_t currentTime);
  void checkForTaskCompletions(TaskSet *taskSet, TickType_t currentTime);
  Task* getHighestPriorityTask(TaskSet *taskSet);
@@ -33,6 +34,7 @@
  TickType_t calculateSimulationEndTime(TaskSet *taskSet);
  void executeTask(Task *task, PowerState *powerState, TickType_t *currentTime);
  void updateStats(SchedulerStats *stats, PowerState *powerState, Task *currentTask, TickType_t currentTime);
+ void updateStatsForTicks(SchedulerStats *stats, const PowerState *powerState, TickType_t startTime, TickType_t ticks);
  void logSchedulerState(FILE *file, TickType_t time, Task *task, PowerState powerState, 
                        TickType_t slack, PowerDecision decision);
  
@@ -14,6 +14,15 @@
  // Function prototypes for FreeRTOS task API
  TickType_t xTaskGetTickCount(void);
  void vTaskDelay(const TickType_t xTicksToDelay);
+ void vTaskStepTick(const TickType_t xTicksToJump);
+ 
+ // Host port: starts the tick source and returns, so the calling thread
+ // becomes the single application task
+ void vTaskStartScheduler(void);
+ void vTaskEndScheduler(void);
+ 
+ // Application hook called from the tick interrupt (configUSE_TICK_HOOK)
+ void vApplicationTickHook(void);
  
  #ifdef __cplusplus
  }
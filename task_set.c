@@ -37,16 +37,57 @@
              continue;
          }
          
-         // Parse task parameters: ID, Period, Deadline, WCET
+         // Parse task parameters: ID, Period, Deadline, WCET, an optional kind
+         // and an optional criticality (HI with its HI-mode WCET, or LO)
          int id;
-         TickType_t period, deadline, wcet;
+         TickType_t period, deadline, wcet, wcetHi = 0;
+         char kindName[16] = "P";
+         char criticalityName[16] = "LO";
          
-         int result = sscanf(line, "%d %u %u %u", &id, &period, &deadline, &wcet);
-         if (result != 4) {
+         int result = sscanf(line, "%d %u %u %u %15s %15s %u", &id, &period, &deadline, &wcet,
+                             kindName, criticalityName, &wcetHi);
+         if (result < 4) {
              printf("Error parsing task parameters at line %d\n", lineCount);
              continue;
          }
          
+         TaskKind kind;
+         if (kindName[0] == '#' || strcmp(kindName, "P") == 0) {
+             kind = TASK_PERIODIC;
+         } else if (strcmp(kindName, "S") == 0) {
+             kind = TASK_SPORADIC;
+         } else if (strcmp(kindName, "TBS") == 0) {
+             kind = TASK_SERVER_TBS;
+         } else if (strcmp(kindName, "CBS") == 0) {
+             kind = TASK_SERVER_CBS;
+         } else {
+             printf("Error: Unknown task kind '%s' at line %d\n", kindName, lineCount);
+             continue;
+         }
+         
+         if (kind != TASK_PERIODIC && (period == 0 || wcet == 0)) {
+             printf("Error: Task %d needs a non-zero period and WCET at line %d\n", id, lineCount);
+             continue;
+         }
+         
+         Criticality criticality = CRITICALITY_LO;
+         if (kindName[0] == '#' || criticalityName[0] == '#' || strcmp(criticalityName, "LO") == 0) {
+             wcetHi = wcet;
+         } else if (strcmp(criticalityName, "HI") == 0) {
+             if (result < 7 || wcetHi < wcet) {
+                 printf("Error: HI task %d needs a HI WCET of at least its WCET at line %d\n", id, lineCount);
+                 continue;
+             }
+             if (kind == TASK_SERVER_TBS || kind == TASK_SERVER_CBS) {
+                 printf("Error: Aperiodic server %d cannot be HI criticality at line %d\n", id, lineCount);
+                 continue;
+             }
+             criticality = CRITICALITY_HI;
+         } else {
+             printf("Error: Unknown criticality '%s' at line %d\n", criticalityName, lineCount);
+             continue;
+         }
+         
          if (taskSet->count >= MAX_TASKS) {
              printf("Warning: Maximum number of tasks reached. Ignoring task %d.\n", id);
              continue;
@@ -55,13 +96,16 @@
          // Initialize task
          Task *task = &taskSet->tasks[taskSet->count];
          task->id = id;
+         task->kind = kind;
          task->period = period;
          task->relativeDeadline = deadline;
          task->worstCaseExecTime = wcet;
+         task->criticality = criticality;
+         task->wcetHi = wcetHi;
          
          // Initialize runtime variables
          task->state = TASK_IDLE;
-         task->nextArrivalTime = 0;  // First instance arrives at time 0
+         task->nextArrivalTime = 0;  // First instance arrives at time 0 (or at its first trace record)
          task->remainingExecutionTime = 0;
          task->currentInstance = 0;
          
@@ -146,4 +190,178 @@
      fclose(file);
      printf("Loaded execution times from %s\n", filename);
      return true;
+ }
+ 
+ bool isAperiodicServer(const Task *task) {
+     return task->kind == TASK_SERVER_TBS || task->kind == TASK_SERVER_CBS;
+ }
+ 
+ bool taskSetNeedsArrivalTrace(const TaskSet *taskSet) {
+     for (int i = 0; i < taskSet->count; i++) {
+         if (taskSet->tasks[i].kind != TASK_PERIODIC) {
+             return true;
+         }
+     }
+     return false;
+ }
+ 
+ // Sort records by release time, keeping trace order among equal times so
+ // that aperiodic jobs released together reach their server in file order.
+ // Bottom-up merge sort; qsort is not stable.
+ static bool sortArrivalRecords(ArrivalRecord *records, unsigned int count) {
+     ArrivalRecord *buffer = malloc(count * sizeof(ArrivalRecord));
+     if (buffer == NULL) {
+         return false;
+     }
+     
+     ArrivalRecord *from = records, *to = buffer;
+     for (unsigned int width = 1; width < count; width *= 2) {
+         for (unsigned int low = 0; low < count; low += 2 * width) {
+             unsigned int middle = low + width < count ? low + width : count;
+             unsigned int high = middle + width < count ? middle + width : count;
+             unsigned int left = low, right = middle, out = low;
+             
+             // Ties take the left run first
+             while (left < middle && right < high) {
+                 if (from[right].releaseTime < from[left].releaseTime) {
+                     to[out++] = from[right++];
+                 } else {
+                     to[out++] = from[left++];
+                 }
+             }
+             while (left < middle) {
+                 to[out++] = from[left++];
+             }
+             while (right < high) {
+                 to[out++] = from[right++];
+             }
+         }
+         
+         ArrivalRecord *swap = from;
+         from = to;
+         to = swap;
+     }
+     
+     if (from != records) {
+         memcpy(records, from, count * sizeof(ArrivalRecord));
+     }
+     free(buffer);
+     return true;
+ }
+ 
+ bool loadArrivalTrace(const char *filename, TaskSet *taskSet) {
+     FILE *file = fopen(filename, "r");
+     if (file == NULL) {
+         printf("Error opening arrival trace file: %s\n", filename);
+         return false;
+     }
+     
+     char line[256];
+     int lineCount = 0;
+     unsigned int capacity[MAX_TASKS] = {0};
+     bool sorted[MAX_TASKS];
+     unsigned long totalRecords = 0;
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         sorted[i] = true;
+     }
+     
+     // Read header line
+     if (fgets(line, sizeof(line), file) == NULL) {
+         printf("Error reading header line from arrival trace file.\n");
+         fclose(file);
+         return false;
+     }
+     
+     // Process release records
+     while (fgets(line, sizeof(line), file) != NULL) {
+         lineCount++;
+         
+         // Skip empty lines and comments
+         if (line[0] == '\n' || line[0] == '#') {
+             continue;
+         }
+         
+         // Parse line: TaskID, ReleaseTime, ActualExecTime
+         int taskId;
+         TickType_t releaseTime, execTime;
+         
+         int result = sscanf(line, "%d %u %u", &taskId, &releaseTime, &execTime);
+         if (result != 3) {
+             printf("Error parsing arrival record at line %d\n", lineCount);
+             continue;
+         }
+         
+         // Find the task
+         int index = -1;
+         for (int i = 0; i < taskSet->count; i++) {
+             if (taskSet->tasks[i].id == taskId) {
+                 index = i;
+                 break;
+             }
+         }
+         
+         if (index < 0) {
+             printf("Warning: No task with ID %d found. Ignoring arrival record.\n", taskId);
+             continue;
+         }
+         
+         Task *task = &taskSet->tasks[index];
+         if (task->kind == TASK_PERIODIC) {
+             printf("Warning: Task %d is periodic. Ignoring arrival record at line %d.\n", taskId, lineCount);
+             continue;
+         }
+         
+         // Grow the task's trace geometrically
+         if (task->arrivalCount == capacity[index]) {
+             unsigned int newCapacity = capacity[index] == 0 ? 64 : capacity[index] * 2;
+             ArrivalRecord *grown = realloc(task->arrivals, newCapacity * sizeof(ArrivalRecord));
+             if (grown == NULL) {
+                 printf("Error allocating memory for arrival trace.\n");
+                 fclose(file);
+                 return false;
+             }
+             task->arrivals = grown;
+             capacity[index] = newCapacity;
+         }
+         
+         if (task->arrivalCount > 0 &&
+             task->arrivals[task->arrivalCount - 1].releaseTime > releaseTime) {
+             sorted[index] = false;
+         }
+         
+         task->arrivals[task->arrivalCount].releaseTime = releaseTime;
+         task->arrivals[task->arrivalCount].executionTime = execTime;
+         task->arrivalCount++;
+         totalRecords++;
+     }
+     
+     fclose(file);
+     
+     // Releases are consumed in time order
+     for (int i = 0; i < taskSet->count; i++) {
+         Task *task = &taskSet->tasks[i];
+         if (!sorted[i] && !sortArrivalRecords(task->arrivals, task->arrivalCount)) {
+             printf("Error allocating memory for arrival trace.\n");
+             return false;
+         }
+         if (task->arrivalCount > 0) {
+             task->nextArrivalTime = task->arrivals[0].releaseTime;
+         }
+     }
+     
+     printf("Loaded %lu arrival records from %s\n", totalRecords, filename);
+     return true;
+ }
+ 
+ void freeTaskSet(TaskSet *taskSet) {
+     for (int i = 0; i < taskSet->count; i++) {
+         free(taskSet->tasks[i].arrivals);
+         taskSet->tasks[i].arrivals = NULL;
+         taskSet->tasks[i].arrivalCount = 0;
+         taskSet->tasks[i].dvfsTable = NULL;
+     }
+     
+     free(taskSet->dvfsTables.pool);
+     memset(&taskSet->dvfsTables, 0, sizeof(DVFSTablePool));
  }
\ No newline at end of file
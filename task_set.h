@@ -5,8 +5,11 @@
  #ifndef TASK_SET_H
  #define TASK_SET_H
  
+ #include <stddef.h>
  #include "FreeRTOS.h"
  #include "task.h"
+ #include "event_queue.h"
+ #include "histogram.h"
  
  #define MAX_TASKS 50
  #define MAX_INSTANCES 100
@@ -18,12 +21,45 @@
      TASK_RUNNING  // Currently executing
  } TaskState;
  
+ // Task kinds
+ typedef enum {
+     TASK_PERIODIC,    // Released every period
+     TASK_SPORADIC,    // Released from an arrival trace, at least one period apart
+     TASK_SERVER_TBS,  // Total Bandwidth Server for aperiodic jobs
+     TASK_SERVER_CBS   // Constant Bandwidth Server for aperiodic jobs
+ } TaskKind;
+ 
+ // Criticality levels
+ typedef enum {
+     CRITICALITY_LO,  // Best-effort: only guaranteed in LO mode
+     CRITICALITY_HI   // Safety-critical: guaranteed up to its HI WCET
+ } Criticality;
+ 
+ // Treatment of LO tasks while the system is in HI mode
+ typedef enum {
+     MC_DROP_LO,     // Abort active LO jobs and skip their releases
+     MC_DEGRADE_LO   // Keep active LO jobs, release them at a reduced rate
+ } LowCriticalityPolicy;
+ 
+ #define MC_DEGRADE_PERIOD_FACTOR 2  // LO period stretch in HI mode when degrading
+ 
+ // One release from an arrival trace
+ typedef struct {
+     TickType_t releaseTime;    // Requested release time
+     TickType_t executionTime;  // Actual execution time of the released job
+ } ArrivalRecord;
+ 
  // Task structure
  typedef struct Task {
      int id;                     // Task ID
-     TickType_t period;          // Task period
+     TaskKind kind;              // Periodic, sporadic or aperiodic server
+     TickType_t period;          // Task period (minimum inter-arrival time for sporadic
+                                 // tasks, server period for aperiodic servers)
      TickType_t relativeDeadline; // Relative deadline
-     TickType_t worstCaseExecTime; // Worst-case execution time
+     TickType_t worstCaseExecTime; // Worst-case execution time (budget for aperiodic servers;
+                                   // LO-mode budget for HI tasks)
+     Criticality criticality;      // LO unless given as HI in the task set
+     TickType_t wcetHi;            // HI-mode WCET of HI tasks
      
      // Runtime information
      TaskState state;
@@ -32,25 +68,76 @@
      TickType_t remainingExecutionTime; // Remaining execution time
      TickType_t arrivalTime;       // Arrival time of current instance
      TickType_t completionTime;    // Completion time of current instance
+     TickType_t instanceExecutionTime; // Actual execution time of current instance
+     bool releasePending;          // Release fell due while the previous instance was active
+     TickType_t virtualDeadline;   // EDF-VD deadline of the current instance (HI tasks)
      
      // Actual execution times for simulation
      TickType_t actualExecutionTime[MAX_INSTANCES];
      int currentInstance;
      
+     // Arrival trace (sporadic tasks and aperiodic servers)
+     ArrivalRecord *arrivals;
+     unsigned int arrivalCount;
+     unsigned int nextArrival;     // Next trace record to be released
+     
+     // Aperiodic server state; jobs [nextServedJob, nextArrival) are queued
+     unsigned int nextServedJob;
+     TickType_t serverBudget;      // Remaining CBS budget
+     TickType_t serverDeadline;    // Current server deadline
+     
+     // Precomputed DVFS decisions, indexed [work][timeToDeadline]; NULL if not tabulated
+     const unsigned char *dvfsTable;
+     TickType_t dvfsTableWork;     // Largest work covered by the table
+     TickType_t dvfsTableDeadline; // Largest time to deadline covered by the table
+     
      // Statistics
      unsigned int instancesCompleted;
      unsigned int deadlineMisses;
      TickType_t totalResponseTime;
+     TickType_t maxResponseTime;
+     unsigned int jobsDropped;     // LO jobs aborted or skipped in HI mode
  } Task;
  
+ // Backing memory of the per-task DVFS decision tables
+ typedef struct {
+     unsigned char *pool;  // All per-task tables, one allocation
+     size_t size;          // Bytes in use
+     size_t budget;        // Upper bound on size
+     uint32_t signature;   // Fingerprint of the task set the tables were built from
+     bool valid;
+ } DVFSTablePool;
+ 
+ // Mixed-criticality state of a task set
+ typedef struct {
+     bool enabled;                   // The task set has at least one HI task
+     Criticality mode;               // Current system criticality mode
+     LowCriticalityPolicy policy;
+     bool useVirtualDeadlines;       // Schedule HI tasks by EDF-VD deadlines in LO mode
+     bool boostOnModeSwitch;         // Run at the highest frequency while in HI mode
+     double virtualDeadlineFactor;   // EDF-VD scaling factor x
+     unsigned int modeSwitches;
+     TickType_t modeSwitchTime;      // Start of the current HI-mode interval
+     TickType_t timeInHighMode;      // Completed HI-mode intervals
+ } CriticalityState;
+ 
  // Task set structure
  typedef struct {
      Task tasks[MAX_TASKS];
      int count;
+     EventQueue releaseQueue;  // Pending releases, earliest first
+     DVFSTablePool dvfsTables; // Precomputed DVFS decisions (optional)
+     CriticalityState criticality; // Mixed-criticality mode and policy
+     Histogram responseTimes[MAX_TASKS]; // Response time distribution of each task
+     uint32_t fingerprint;     // calculateTaskSetFingerprint() of the loaded inputs
  } TaskSet;
  
  // Function prototypes
  bool loadTaskSet(const char *filename, TaskSet *taskSet);
  bool loadActualExecutionTimes(const char *filename, TaskSet *taskSet);
+ bool loadArrivalTrace(const char *filename, TaskSet *taskSet);
+ bool taskSetNeedsArrivalTrace(const TaskSet *taskSet);
+ bool isAperiodicServer(const Task *task);
+ void freeTaskSet(TaskSet *taskSet);
  
  #endif /* TASK_SET_H */
\ No newline at end of file
@@ -0,0 +1,269 @@
+/**
+ * thermal.c - RC-network thermal model with throttling
+ *
+ * The die and the heat sink form a two-node RC network driven by the power
+ * of the current power state:
+ *
+ *   C_die  dT_die/dt  = P - (T_die - T_sink) / R_die_sink
+ *   C_sink dT_sink/dt = (T_die - T_sink) / R_die_sink - (T_sink - T_amb) / R_sink_amb
+ *
+ * Power only changes when the power state does, so the model is not stepped
+ * per tick. Under constant power the solution is a steady state plus two
+ * decaying exponentials (the eigenmodes of the network). The model jumps
+ * straight to the next power change in closed form, and accumulates the
+ * peak and the time integral of the die temperature exactly on the way.
+ *
+ * Throttling caps the frequency level once the die reaches
+ * THERMAL_THROTTLE_TEMP and lifts the cap at THERMAL_RELEASE_TEMP. Each time
+ * the power changes, the tick at which the die will cross the next threshold
+ * is found in advance. The die temperature has at most one turning point
+ * per interval, so a bisection on each monotonic part finds it. Between
+ * events, the only per-tick cost is comparing the time against that tick.
+ */
+
+ #include <stdio.h>
+ #include <math.h>
+ #include "thermal.h"
+ 
+ #define THERMAL_SETTLING_CONSTANTS 40.0  // Slow time constants until steady state
+ 
+ void initializeThermalModel(ThermalModel *model, bool throttleEnabled, TickType_t startTime) {
+     // System matrix of the temperature rise above ambient
+     double a11 = -1.0 / (THERMAL_R_DIE_SINK * THERMAL_C_DIE);
+     double a12 = 1.0 / (THERMAL_R_DIE_SINK * THERMAL_C_DIE);
+     double a21 = 1.0 / (THERMAL_R_DIE_SINK * THERMAL_C_SINK);
+     double a22 = -(1.0 / THERMAL_R_DIE_SINK + 1.0 / THERMAL_R_SINK_AMBIENT) / THERMAL_C_SINK;
+     
+     // Real, negative eigenvalues; mode 0 is the slow one
+     double trace = a11 + a22;
+     double root = sqrt(trace * trace - 4.0 * (a11 * a22 - a12 * a21));
+     model->lambda[0] = (trace + root) / 2.0;
+     model->lambda[1] = (trace - root) / 2.0;
+     
+     for (int mode = 0; mode < 2; mode++) {
+         model->eigenvector[0][mode] = a12;
+         model->eigenvector[1][mode] = model->lambda[mode] - a11;
+     }
+     
+     double determinant = model->eigenvector[0][0] * model->eigenvector[1][1] -
+                          model->eigenvector[0][1] * model->eigenvector[1][0];
+     model->inverse[0][0] = model->eigenvector[1][1] / determinant;
+     model->inverse[0][1] = -model->eigenvector[0][1] / determinant;
+     model->inverse[1][0] = -model->eigenvector[1][0] / determinant;
+     model->inverse[1][1] = model->eigenvector[0][0] / determinant;
+     
+     model->rise[0] = model->rise[1] = 0.0;
+     model->power = -1.0;  // Set by the first update
+     model->lastUpdateTime = startTime;
+     model->startTime = startTime;
+     model->nextEventTime = portMAX_DELAY;
+     model->throttleEnabled = throttleEnabled;
+     model->throttled = false;
+     
+     model->peakTemperature = THERMAL_AMBIENT;
+     model->temperatureIntegral = 0.0;
+     model->throttleEvents = 0;
+     model->timeThrottled = 0;
+     model->throttleStartTime = 0;
+ }
+ 
+ // Steady state and mode amplitudes of the current interval
+ static void decompose(const ThermalModel *model, double steady[2], double amplitude[2]) {
+     steady[0] = model->power * (THERMAL_R_DIE_SINK + THERMAL_R_SINK_AMBIENT);
+     steady[1] = model->power * THERMAL_R_SINK_AMBIENT;
+     
+     for (int mode = 0; mode < 2; mode++) {
+         amplitude[mode] = model->inverse[mode][0] * (model->rise[0] - steady[0]) +
+                           model->inverse[mode][1] * (model->rise[1] - steady[1]);
+     }
+ }
+ 
+ static double dieRiseAt(const ThermalModel *model, const double steady[2], const double amplitude[2], double t) {
+     return steady[0] + model->eigenvector[0][0] * amplitude[0] * exp(model->lambda[0] * t) +
+                        model->eigenvector[0][1] * amplitude[1] * exp(model->lambda[1] * t);
+ }
+ 
+ // Time within the interval at which the die temperature turns, or -1
+ static double dieTurningPoint(const ThermalModel *model, const double amplitude[2]) {
+     double w0 = model->eigenvector[0][0] * amplitude[0] * model->lambda[0];
+     double w1 = model->eigenvector[0][1] * amplitude[1] * model->lambda[1];
+     
+     if (w0 == 0.0 || -w1 / w0 <= 0.0) {
+         return -1.0;
+     }
+     double t = log(-w1 / w0) / (model->lambda[0] - model->lambda[1]);
+     return t > 0.0 ? t : -1.0;
+ }
+ 
+ void advanceThermalModel(ThermalModel *model, TickType_t time) {
+     if (time <= model->lastUpdateTime || model->power < 0.0) {
+         model->lastUpdateTime = time > model->lastUpdateTime ? time : model->lastUpdateTime;
+         return;
+     }
+     
+     double steady[2], amplitude[2];
+     decompose(model, steady, amplitude);
+     double dt = (double)(time - model->lastUpdateTime);
+     
+     // A peak inside the interval
+     double turn = dieTurningPoint(model, amplitude);
+     if (turn > 0.0 && turn < dt) {
+         double peak = THERMAL_AMBIENT + dieRiseAt(model, steady, amplitude, turn);
+         if (peak > model->peakTemperature) {
+             model->peakTemperature = peak;
+         }
+     }
+     
+     // Exact integral of the die rise over the interval
+     double integral = steady[0] * dt;
+     for (int mode = 0; mode < 2; mode++) {
+         integral += model->eigenvector[0][mode] * amplitude[mode] *
+                     (exp(model->lambda[mode] * dt) - 1.0) / model->lambda[mode];
+     }
+     model->temperatureIntegral += integral;
+     
+     for (int node = 0; node < 2; node++) {
+         model->rise[node] = steady[node];
+         for (int mode = 0; mode < 2; mode++) {
+             model->rise[node] += model->eigenvector[node][mode] * amplitude[mode] * exp(model->lambda[mode] * dt);
+         }
+     }
+     
+     if (THERMAL_AMBIENT + model->rise[0] > model->peakTemperature) {
+         model->peakTemperature = THERMAL_AMBIENT + model->rise[0];
+     }
+     model->lastUpdateTime = time;
+ }
+ 
+ // Whether the die rise has reached the threshold of the current throttle state
+ static bool thresholdReached(const ThermalModel *model, double dieRise) {
+     if (model->throttled) {
+         return THERMAL_AMBIENT + dieRise <= THERMAL_RELEASE_TEMP;
+     }
+     return THERMAL_AMBIENT + dieRise >= THERMAL_THROTTLE_TEMP;
+ }
+ 
+ // Find the first tick after lastUpdateTime at which the threshold is reached
+ static void scheduleThresholdCrossing(ThermalModel *model) {
+     model->nextEventTime = portMAX_DELAY;
+     if (!model->throttleEnabled) {
+         return;
+     }
+     
+     double steady[2], amplitude[2];
+     decompose(model, steady, amplitude);
+     
+     // Monotonic parts of the die temperature, up to steady state
+     double horizon = THERMAL_SETTLING_CONSTANTS / -model->lambda[0];
+     double turn = dieTurningPoint(model, amplitude);
+     double bounds[3] = {0.0, horizon, horizon};
+     int parts = 1;
+     if (turn > 0.0 && turn < horizon) {
+         bounds[1] = turn;
+         parts = 2;
+     }
+     
+     for (int part = 0; part < parts; part++) {
+         TickType_t low = (TickType_t)floor(bounds[part]) + 1;
+         TickType_t high = (TickType_t)floor(bounds[part + 1]);
+         if (low > high) {
+             continue;
+         }
+         
+         // The threshold test changes at most once along a monotonic part
+         bool reachedLow = thresholdReached(model, dieRiseAt(model, steady, amplitude, low));
+         bool reachedHigh = thresholdReached(model, dieRiseAt(model, steady, amplitude, high));
+         if (!reachedLow && !reachedHigh) {
+             continue;
+         }
+         
+         if (!reachedLow) {
+             while (high - low > 1) {
+                 TickType_t middle = low + (high - low) / 2;
+                 if (thresholdReached(model, dieRiseAt(model, steady, amplitude, middle))) {
+                     high = middle;
+                 } else {
+                     low = middle;
+                 }
+             }
+             low = high;
+         }
+         
+         model->nextEventTime = model->lastUpdateTime + low;
+         return;
+     }
+ }
+ 
+ static void toggleThrottle(ThermalModel *model, PowerState *powerState, TickType_t currentTime) {
+     model->throttled = !model->throttled;
+     
+     if (model->throttled) {
+         model->throttleEvents++;
+         model->throttleStartTime = currentTime;
+         powerState->frequencyCap = THERMAL_THROTTLE_LEVEL;
+         
+         // The hardware clamps the frequency at once, not at the next DVFS decision
+         if (powerState->frequencyLevel > getFrequencyLevel(THERMAL_THROTTLE_LEVEL)) {
+             powerState->frequencyLevel = getFrequencyLevel(THERMAL_THROTTLE_LEVEL);
+         }
+     } else {
+         model->timeThrottled += currentTime - model->throttleStartTime;
+         powerState->frequencyCap = DVFS_LEVELS - 1;
+     }
+ }
+ 
+ // Start or end throttling once the die reaches a threshold. The die
+ // temperature at currentTime does not depend on the power chosen for the
+ // tick, so this runs before the power decision and the decision sees the
+ // new cap.
+ void updateThermalThrottle(ThermalModel *model, PowerState *powerState, TickType_t currentTime) {
+     if (!model->throttleEnabled || currentTime < model->nextEventTime) {
+         return;
+     }
+     
+     advanceThermalModel(model, currentTime);
+     if (thresholdReached(model, model->rise[0])) {
+         toggleThrottle(model, powerState, currentTime);
+     }
+ }
+ 
+ void updateThermalModel(ThermalModel *model, const PowerState *powerState, TickType_t currentTime) {
+     double power = calculateTickEnergy(powerState);
+     
+     // Nothing to do until the power changes or a threshold is crossed
+     if (currentTime < model->nextEventTime && power == model->power) {
+         return;
+     }
+     
+     advanceThermalModel(model, currentTime);
+     model->power = power;
+     scheduleThresholdCrossing(model);
+ }
+ 
+ double getAverageTemperature(const ThermalModel *model) {
+     TickType_t elapsed = model->lastUpdateTime - model->startTime;
+     if (elapsed == 0) {
+         return THERMAL_AMBIENT + model->rise[0];
+     }
+     return THERMAL_AMBIENT + model->temperatureIntegral / elapsed;
+ }
+ 
+ TickType_t getTimeThrottled(const ThermalModel *model) {
+     if (model->throttled) {
+         return model->timeThrottled + (model->lastUpdateTime - model->throttleStartTime);
+     }
+     return model->timeThrottled;
+ }
+ 
+ void logThermalModel(FILE *file, const ThermalModel *model) {
+     fprintf(file, "Thermal model (2-node RC, ambient %.1f C):\n", THERMAL_AMBIENT);
+     fprintf(file, "  - Peak die temperature: %.2f C\n", model->peakTemperature);
+     fprintf(file, "  - Average die temperature: %.2f C\n", getAverageTemperature(model));
+     if (model->throttleEnabled) {
+         fprintf(file, "  - Throttling (cap %.1f at %.1f C, lifted at %.1f C): %u events, %u ticks\n",
+                 getFrequencyLevel(THERMAL_THROTTLE_LEVEL), THERMAL_THROTTLE_TEMP, THERMAL_RELEASE_TEMP,
+                 model->throttleEvents, (unsigned int)getTimeThrottled(model));
+     } else {
+         fprintf(file, "  - Throttling: disabled\n");
+     }
+ }
@@ -0,0 +1,59 @@
+/**
+ * thermal.h - RC-network thermal model with throttling
+ */
+
+ #ifndef THERMAL_H
+ #define THERMAL_H
+ 
+ #include <stdio.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ 
+ // Two-node network: die -> heat sink -> ambient. Power is in energy units
+ // per tick, resistances in degrees C per power unit, capacitances in power
+ // units x ticks per degree C.
+ #define THERMAL_AMBIENT            45.0
+ #define THERMAL_R_DIE_SINK         10.0
+ #define THERMAL_C_DIE              0.5
+ #define THERMAL_R_SINK_AMBIENT     40.0
+ #define THERMAL_C_SINK             10.0
+ 
+ // Throttling policy with hysteresis
+ #define THERMAL_THROTTLE_TEMP      85.0  // Cap the frequency at or above this die temperature
+ #define THERMAL_RELEASE_TEMP       80.0  // Lift the cap at or below this die temperature
+ #define THERMAL_THROTTLE_LEVEL     2     // Highest frequency level index while throttled (0.8)
+ 
+ // Thermal state
+ typedef struct {
+     // Network constants: eigenvalues and eigenvectors of the system matrix
+     double lambda[2];
+     double eigenvector[2][2];     // [node][mode]
+     double inverse[2][2];         // Inverse of the eigenvector matrix
+     
+     // State at lastUpdateTime, as temperature rise above ambient
+     double rise[2];               // Die, sink
+     double power;                 // Power applied since lastUpdateTime
+     TickType_t lastUpdateTime;
+     TickType_t startTime;
+     TickType_t nextEventTime;     // Next throttle threshold crossing, or portMAX_DELAY
+     bool throttleEnabled;
+     bool throttled;
+     
+     // Statistics
+     double peakTemperature;
+     double temperatureIntegral;   // Integral of the die rise since startTime
+     unsigned int throttleEvents;
+     TickType_t timeThrottled;     // Completed throttled intervals
+     TickType_t throttleStartTime;
+ } ThermalModel;
+ 
+ // Function prototypes
+ void initializeThermalModel(ThermalModel *model, bool throttleEnabled, TickType_t startTime);
+ void updateThermalThrottle(ThermalModel *model, PowerState *powerState, TickType_t currentTime);
+ void updateThermalModel(ThermalModel *model, const PowerState *powerState, TickType_t currentTime);
+ void advanceThermalModel(ThermalModel *model, TickType_t time);
+ double getAverageTemperature(const ThermalModel *model);
+ TickType_t getTimeThrottled(const ThermalModel *model);
+ void logThermalModel(FILE *file, const ThermalModel *model);
+ 
+ #endif /* THERMAL_H */
@@ -27,6 +27,8 @@
                            
  BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
  BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+ void *pvTimerGetTimerID(const TimerHandle_t xTimer);
+ TickType_t xTimerGetExpiryTime(TimerHandle_t xTimer);
  
  #ifdef __cplusplus
  }
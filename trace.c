@@ -0,0 +1,95 @@
+/**
+ * trace.c - Machine-readable schedule trace
+ *
+ * The trace carries the same information as output.txt in a form that is
+ * cheap to parse, so that two runs can be compared by schedule_diff while
+ * they are still being produced. Every scheduler row becomes one state
+ * record, followed at the end of the run by one metric record per value in
+ * analysis.txt:
+ *
+ *   S <time> <task id or -> <remaining> <deadline> <frequency> <dpm 0/1> <slack or MAX> <decision>
+ *   M <name> <value>
+ *
+ * The decision is one of none, dvfs:<frequency>, dpm-on or dpm-off.
+ */
+
+ #include <stdio.h>
+ #include "trace.h"
+ 
+ FILE *openTraceFile(const char *filename) {
+     FILE *file = fopen(filename, "w");
+     if (file == NULL) {
+         printf("Error opening trace file: %s\n", filename);
+         return NULL;
+     }
+     
+     // Traces can run to gigabytes; write them in large blocks
+     setvbuf(file, NULL, _IOFBF, TRACE_BUFFER_SIZE);
+     fprintf(file, "%s\n", TRACE_FORMAT_HEADER);
+     return file;
+ }
+ 
+ void writeTraceState(FILE *file, TickType_t time, Task *task, PowerState powerState,
+                      TickType_t slack, PowerDecision decision) {
+     if (task != NULL) {
+         fprintf(file, "S %u %d %u %u", (unsigned int)time, task->id,
+                 (unsigned int)task->remainingExecutionTime, (unsigned int)task->absoluteDeadline);
+     } else {
+         fprintf(file, "S %u - 0 0", (unsigned int)time);
+     }
+     
+     fprintf(file, " %.1f %d", powerState.frequencyLevel, powerState.isDPMActive ? 1 : 0);
+     
+     if (slack == portMAX_DELAY) {
+         fprintf(file, " MAX");
+     } else {
+         fprintf(file, " %u", (unsigned int)slack);
+     }
+     
+     switch (decision.type) {
+         case POWER_DVFS_CHANGE:
+             fprintf(file, " dvfs:%.1f\n", decision.newFrequencyLevel);
+             break;
+         case POWER_DPM_ON:
+             fprintf(file, " dpm-on\n");
+             break;
+         case POWER_DPM_OFF:
+             fprintf(file, " dpm-off\n");
+             break;
+         case POWER_NO_CHANGE:
+         default:
+             fprintf(file, " none\n");
+             break;
+     }
+ }
+ 
+ void writeTraceMetrics(FILE *file, const TaskSet *taskSet, const SchedulerStats *stats,
+                        const ThermalModel *thermal) {
+     fprintf(file, "M total_ticks %u\n", (unsigned int)stats->totalExecutionTime);
+     fprintf(file, "M energy %.6f\n", stats->energyConsumption);
+     fprintf(file, "M dvfs_transitions %u\n", stats->dvfsTransitions);
+     fprintf(file, "M dpm_transitions %u\n", stats->dpmTransitions);
+     for (int i = DVFS_LEVELS - 1; i >= 0; i--) {
+         fprintf(file, "M ticks_at_%.1f %u\n", getFrequencyLevel(i), (unsigned int)stats->timeAtFrequency[i]);
+     }
+     fprintf(file, "M ticks_power_down %u\n", (unsigned int)stats->timeInPowerDown);
+     fprintf(file, "M peak_temperature %.6f\n", thermal->peakTemperature);
+     fprintf(file, "M avg_temperature %.6f\n", getAverageTemperature(thermal));
+     fprintf(file, "M throttle_events %u\n", thermal->throttleEvents);
+     fprintf(file, "M ticks_throttled %u\n", (unsigned int)getTimeThrottled(thermal));
+     if (taskSet->criticality.enabled) {
+         fprintf(file, "M mode_switches %u\n", taskSet->criticality.modeSwitches);
+     }
+     
+     for (int i = 0; i < taskSet->count; i++) {
+         const Task *task = &taskSet->tasks[i];
+         fprintf(file, "M task%d_completed %u\n", task->id, task->instancesCompleted);
+         fprintf(file, "M task%d_misses %u\n", task->id, task->deadlineMisses);
+         fprintf(file, "M task%d_avg_response %.6f\n", task->id,
+                 task->instancesCompleted > 0 ? (double)task->totalResponseTime / task->instancesCompleted : 0.0);
+         fprintf(file, "M task%d_max_response %u\n", task->id, (unsigned int)task->maxResponseTime);
+         if (taskSet->criticality.enabled) {
+             fprintf(file, "M task%d_dropped %u\n", task->id, task->jobsDropped);
+         }
+     }
+ }
@@ -0,0 +1,25 @@
+/**
+ * trace.h - Machine-readable schedule trace
+ */
+
+ #ifndef TRACE_H
+ #define TRACE_H
+ 
+ #include <stdio.h>
+ #include "FreeRTOS.h"
+ #include "power_manager.h"
+ #include "scheduler.h"
+ #include "task_set.h"
+ #include "thermal.h"
+ 
+ #define TRACE_FORMAT_HEADER "# schedule trace v1"
+ #define TRACE_BUFFER_SIZE (64 * 1024)
+ 
+ // Function prototypes
+ FILE *openTraceFile(const char *filename);
+ void writeTraceState(FILE *file, TickType_t time, Task *task, PowerState powerState,
+                      TickType_t slack, PowerDecision decision);
+ void writeTraceMetrics(FILE *file, const TaskSet *taskSet, const SchedulerStats *stats,
+                        const ThermalModel *thermal);
+ 
+ #endif /* TRACE_H */